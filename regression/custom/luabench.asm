@@ -0,0 +1,30 @@
+; Emits and reads 48K with the per-byte calls and with the bulk calls and
+; prints the time of each, `make bench`
+
+        device zxspectrum48
+
+        lua pass3
+            local Size, Repeats = 49152, 20
+            local Values, Chars = {}, {}
+            for i = 1, Size do
+                Values[i] = (i * 7) % 256
+                Chars[i] = string.char(Values[i])
+            end
+            local Bytes = table.concat(Chars)
+
+            local function bench(Name, Emit)
+                local Start = os.clock()
+                for r = 1, Repeats do
+                    _pc("org #4000")
+                    Emit()
+                end
+                print(string.format("%-10s %8.3f ms per 48K", Name, (os.clock() - Start) * 1000 / Repeats))
+            end
+
+            bench("add_byte", function() for i = 1, Size do sj.add_byte(Values[i]) end end)
+            bench("add_word", function() for i = 1, Size, 2 do sj.add_word(Values[i] + Values[i + 1] * 256) end end)
+            bench("add_bytes", function() sj.add_bytes(Bytes) end)
+            bench("emit_table", function() sj.emit_table(Values) end)
+            bench("get_byte", function() for i = 0, Size - 1 do sj.get_byte(16384 + i) end end)
+            bench("get_bytes", function() sj.get_bytes(16384, Size) end)
+        endlua
@@ -0,0 +1,29 @@
+        device zxspectrum48
+        org #8000
+a1
+        lua allpass
+            for i = 0, 299 do sj.add_byte((i * 7) % 256) end
+        endlua
+a2
+        lua allpass
+            local t = {}
+            for i = 0, 299 do t[#t + 1] = string.char((i * 7) % 256) end
+            sj.add_bytes(table.concat(t))
+        endlua
+a3
+        lua allpass
+            local t = {}
+            for i = 0, 299 do t[#t + 1] = i * 7 end
+            sj.emit_table(t)
+        endlua
+a4
+        lua pass3
+            sj.fill(36864, 16, 229)
+            local s = sj.get_bytes(sj.get_label("a1"), 300)
+            assert(s == sj.get_bytes(sj.get_label("a2"), 300) and s == sj.get_bytes(sj.get_label("a3"), 300))
+            assert(#s == 300 and string.byte(s, 2) == 7)
+            assert(sj.get_bytes(36864, 16) == string.rep("\229", 16))
+        endlua
+        assert a2 - a1 == 300 && a3 - a2 == 300 && a4 - a3 == 300
+        savebin "luabytes.bin",a1,a4-a1
+        savebin "luafill.bin",#9000,16
@@ -0,0 +1,12 @@
+        device zxspectrum48
+
+        org #8000
+text    incbin "pack.asm"
+end
+
+        savebin "pack.zx0",text,end-text,zx0
+        savebin "pack.lz4",text,end-text,lz4
+
+        output "pack.bin"
+        incbin "pack.asm",0,0,zx0
+        incbin "pack.asm",16,64,lz4
@@ -0,0 +1,16 @@
+        device zxspectrum48
+        org #8000
+
+        ; INCLUDELUA run by the LUA block is a nested block
+        lua pass1
+            _pl(' includelua "profile.lua"')
+            function twice(n)
+                emit(n)
+                emit(n)
+            end
+        endlua
+start
+        lua allpass
+            twice(3)
+        endlua
+        assert $ - start == 6
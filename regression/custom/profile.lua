@@ -0,0 +1,3 @@
+function emit(n)
+    for i = 1, n do _pc("nop") end
+end
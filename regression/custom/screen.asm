@@ -0,0 +1,7 @@
+; one byte of the screen is used, so the tape loads the screen
+        device zxspectrum48
+        org #4000
+        db #ff
+        org #8000
+start   jr $
+        savetap "screen.tap", start
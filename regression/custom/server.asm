@@ -0,0 +1,8 @@
+        device zxspectrum48
+        org #8000
+start   jr $
+        ; printed through the messages, so the client shows it
+        lua pass3
+            print("start", sj.get_label("start"), nil)
+        endlua
+        savebin "server.bin",start,2
@@ -0,0 +1,2 @@
+        ; an error of the directive parser, which the client shows too
+        define 1bad
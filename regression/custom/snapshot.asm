@@ -0,0 +1,15 @@
+        device zxspectrum128
+
+        org #8000
+start   di
+        ld a,1
+        out (#fe),a
+        jr $
+        ; a run of equal bytes to compress
+        block 300,#ed
+        page 4
+        org #c000
+        db 'page4'
+
+        SAVEZ80 "snapshot.z80",start
+        SAVESZX "snapshot.szx",start
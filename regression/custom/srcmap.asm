@@ -0,0 +1,8 @@
+        device zxspectrum128
+        ; page 5 through slot 3, then through slot 1: the later byte replaces
+        ; the first one in the map
+        page 5
+        org #c000
+        db 1,2,3
+        org #4000
+        db 4
@@ -0,0 +1,20 @@
+        device zxspectrum128
+
+        org #8000
+main    db 'main'
+        page 1
+        org #c000
+level1  db 'level1'
+        page 3
+        org #c000
+level2  db 'level2'
+end
+
+        EMPTYTAP tap.tap
+        SAVETAPBLOCK "tap.tap","main",main,4
+        SAVETAPBLOCK "tap.tap","level1",level1,6,1
+        SAVETAPBLOCK "tap.tap","",level2,6,3
+
+        ; the longest block, its length on tape is FFFFh
+        EMPTYTAP tapmax.tap
+        SAVETAPBLOCK "tapmax.tap","max",1,65534
@@ -0,0 +1,11 @@
+        device zxspectrum48
+        org #8000
+one     db 1
+two     db 2
+three   db 3
+
+        ; the same tape under other spellings of its name
+        EMPTYTAP "tapalias.tap"
+        SAVETAPBLOCK "tapalias.tap","one",one,1
+        SAVETAPBLOCK "./tapalias.tap","two",two,1
+        SAVETAPBLOCK "../custom/tapalias.tap","three",three,1
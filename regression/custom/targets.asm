@@ -0,0 +1,12 @@
+; one source, a binary per target of targets.txt
+    device zxspectrum48
+    org #8000
+start:
+    IF MODEL == 128
+    ld bc,#7ffd
+    out (c),a
+    ENDIF
+    ld a,MODEL
+    db NAME
+    incbin "test.raw", 0, 4
+    savebin OUT, start, $-start
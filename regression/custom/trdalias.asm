@@ -0,0 +1,9 @@
+        device zxspectrum48
+        org #8000
+one     db 'one'
+two     db 'two'
+
+        ; the same image under other spellings of its name
+        EMPTYTRD "trdalias.trd"
+        SAVETRD "./trdalias.trd","one.txt",one,3
+        SAVETRD "../custom/trdalias.trd","two.txt",two,3
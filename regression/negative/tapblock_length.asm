@@ -0,0 +1,4 @@
+        device zxspectrum48
+        ; with the flag and checksum bytes these do not fit the 16-bit length
+        SAVETAPBLOCK "tapblock_length.tap","long",0,65535
+        SAVETAPBLOCK "tapblock_length.tap","longer",0,65536
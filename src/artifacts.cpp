@@ -0,0 +1,24 @@
+#include <algorithm>
+#include "threadpool.h"
+#include "artifacts.h"
+
+std::vector<std::string> ArtifactScheduler::run() {
+    std::vector<optional<std::string>> Results(Jobs.size());
+    if (Jobs.size() == 1) {
+        Results[0] = Jobs[0]();
+    } else if (Jobs.size() > 1) {
+        ThreadPool Pool{std::min(ThreadPool::defaultThreads(), (unsigned) Jobs.size())};
+        for (size_t i = 0; i < Jobs.size(); i++) {
+            Pool.submit([this, &Results, i] { Results[i] = Jobs[i](); });
+        }
+        Pool.wait();
+    }
+    Jobs.clear();
+    std::vector<std::string> Errors;
+    for (auto &R : Results) {
+        if (R) {
+            Errors.push_back(*R);
+        }
+    }
+    return Errors;
+}
@@ -0,0 +1,31 @@
+#ifndef SJASMPLUS_ARTIFACTS_H
+#define SJASMPLUS_ARTIFACTS_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+using boost::optional;
+
+// Output files written once assembling is done. The jobs only read the final
+// assembler state, so they run concurrently on a thread pool. Errors are
+// returned by the jobs and reported in the order the jobs were added, so
+// messages do not depend on scheduling.
+class ArtifactScheduler {
+public:
+    using Job = std::function<optional<std::string>()>;
+
+private:
+    std::vector<Job> Jobs;
+
+public:
+    void add(Job J) {
+        Jobs.push_back(std::move(J));
+    }
+
+    // Run all jobs and return their errors in order
+    std::vector<std::string> run();
+};
+
+#endif //SJASMPLUS_ARTIFACTS_H
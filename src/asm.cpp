@@ -4,6 +4,9 @@
 #include "lua_support.h"
 #include <sjasmplus_conf.h>
 #include "asm.h"
+#include "artifacts.h"
+#include "server.h"
+#include "targets.h"
 
 using std::cerr;
 using std::endl;
@@ -13,6 +16,8 @@ void Assembler::init() {
     CurrentDirectory = fs::current_path();
 
     initLUA(); // FIXME
+    Profile.init(Options.ProfileFName);
+    Profile.attach(LUA);
 
     MainSrcFileDir = SrcFileNames.empty() ?
                      CurrentDirectory :
@@ -40,10 +45,11 @@ void Assembler::init() {
 
 }
 
-extern int pass; // FIXME
+extern thread_local int pass; // FIXME
 const int LASTPASS = 3; // FIXME
-extern int ErrorCount; // FIXME
-extern aint CurrentGlobalLine, CurrentLocalLine, CompiledCurrentLine; // FIXME
+extern thread_local int ErrorCount; // FIXME
+extern thread_local aint CurrentGlobalLine, CurrentLocalLine, CompiledCurrentLine; // FIXME
+void flushOutputFiles(); // FIXME
 
 
 void Assembler::assemble(int &RetValue) {
@@ -51,10 +57,16 @@ void Assembler::assemble(int &RetValue) {
     bool W2DEncodingFlag = Options.ConvertWindowsToDOS;
 
     // init first pass
+    auto PassStart = Profile.start();
     initPass(1);
 
     // open lists
     Listing.init(Options.ListingFName);
+    Listing.initBinary(Options.ListingBinFName);
+    SourceMap.init(Options.SourceMapFName);
+    if (Options.DeferSaves) {
+        Saves.enable(ThreadPool::defaultThreads());
+    }
 
     bool PerFileExports = Options.ExportFName.empty();
 
@@ -67,6 +79,7 @@ void Assembler::assemble(int &RetValue) {
         openTopLevelFile(getAbsPath(F), PerFileExports);
     }
 
+    Profile.addPass(1, PassStart);
     _COUT "Pass 1 complete (" _CMDL ErrorCount _CMDL " errors)" _ENDL;
 
     Options.ConvertWindowsToDOS = W2DEncodingFlag;
@@ -74,6 +87,7 @@ void Assembler::assemble(int &RetValue) {
     do {
         pass++;
 
+        PassStart = Profile.start();
         initPass(pass);
 
         for (const auto &F : SrcFileNames) {
@@ -81,6 +95,7 @@ void Assembler::assemble(int &RetValue) {
         }
 
         Em.reset();
+        Profile.addPass(pass, PassStart);
         if (pass != LASTPASS) {
             msg("Pass "s + std::to_string(pass) + " complete ("s + std::to_string(ErrorCount) + " errors)"s);
         } else {
@@ -89,24 +104,63 @@ void Assembler::assemble(int &RetValue) {
     } while (pass < 3);;
 
     delete Exports;
+    Exports = nullptr;
 
-    if (Options.AddLabelListing) {
-        Listing.write(Labels.dump());
+    auto Err = Em.closeRawOutput();
+    if (Err) {
+        Error(*Err, ALL);
     }
 
-    // closeListingFile();
+    Saves.finish();
+    flushOutputFiles();
+
+    // Everything below only reads the final state, so it is written concurrently
+    ArtifactScheduler Artifacts;
+    std::string LabelTable;
+
+    if (Options.AddLabelListing) {
+        Artifacts.add([this, &LabelTable]() -> optional<std::string> {
+            LabelTable = Labels.dump();
+            return boost::none;
+        });
+    }
 
     if (!Options.LabelsListFName.empty()) {
-        Labels.dumpForUnreal(Options.LabelsListFName);
+        Artifacts.add([this] { return Labels.dumpForUnreal(Options.LabelsListFName); });
     }
 
     if (!Options.SymbolListFName.empty()) {
-        Labels.dumpSymbols(Options.SymbolListFName);
+        Artifacts.add([this] { return Labels.dumpSymbols(Options.SymbolListFName); });
+    }
+
+    if (!Options.SymbolBinFName.empty()) {
+        Artifacts.add([this] { return Labels.dumpBinary(Options.SymbolBinFName); });
+    }
+
+    if (SourceMap.isActive()) {
+        Artifacts.add([this] { return SourceMap.write(); });
+    }
+
+    if (Profile.isActive()) {
+        Artifacts.add([this] { return Profile.write(); });
+    }
+
+    for (const auto &Err : Artifacts.run()) {
+        Error(Err, ALL);
+    }
+
+    if (Options.AddLabelListing) {
+        Listing.write(LabelTable);
+    }
+
+    Err = Listing.closeBinary();
+    if (Err) {
+        Error(*Err, ALL);
     }
 
     _COUT "Errors: " _CMDL ErrorCount _CMDL ", warnings: " _CMDL WarningCount _CMDL ", compiled: " _CMDL CompiledCurrentLine _CMDL " lines" _ENDL;
 
-    cout << flush;
+    messageStream() << flush;
 
     // Shutdown Lua
     shutdownLUA();
@@ -116,8 +170,13 @@ void Assembler::assemble(int &RetValue) {
 
 // FIXME:
 void initLegacyErrorHandler(Assembler *_Asm);
+void resetSourceReader();
+void resetGlobals();
 
-Assembler::Assembler(int argc, char *argv[], int &RetValue) :
+Assembler::Assembler(int argc, char *argv[], int &RetValue, std::shared_ptr<AssemblerCaches> _Caches) :
+        Caches{std::move(_Caches)},
+        Files{Caches->Files},
+        Packs{Caches->Packs},
         Em{*this},
         Labels{*this},
         Macros{*this},
@@ -126,26 +185,73 @@ Assembler::Assembler(int argc, char *argv[], int &RetValue) :
         Listing{*this},
         Options{argc, argv, SrcFileNames} {
     initLegacyErrorHandler(this);
+    resetGlobals();
+    resetSourceReader();
     const char *Banner = "SjASMPlus Z80 Cross-Assembler v." SJASMPLUS_VERSION;
 
-    if (argc == 1) {
-        msg(Banner + "\n"s +
-            "based on code of SjASM by Sjoerd Mastijn / http://www.xl2s.tk /\n"s +
-            "Copyright 2004-2008 by Aprisobal / http://sjasmplus.sf.net / my@aprisobal.by /\n" +
-            "\nUsage:\nsjasmplus [options] sourcefile(s)");
-        options::showHelp();
-        exitFail();
-    }
+    try {
+        if (argc == 1) {
+            msg(Banner + "\n"s +
+                "based on code of SjASM by Sjoerd Mastijn / http://www.xl2s.tk /\n"s +
+                "Copyright 2004-2008 by Aprisobal / http://sjasmplus.sf.net / my@aprisobal.by /\n" +
+                "\nUsage:\nsjasmplus [options] sourcefile(s)");
+            options::showHelp();
+            exitFail();
+        }
 
-    if (!Options.HideBanner) {
-        msg(Banner);
-    }
+        if (!Options.HideBanner) {
+            msg(Banner);
+        }
 
+        if (!Options.ClientSocket.empty()) {
+            // The banner is printed here already
+            auto Args = options::argsWithout(argc, argv, "client"s);
+            Args.insert(Args.begin(), "--nologo"s);
+            auto Ret = runClient(Options.ClientSocket, Args);
+            if (Ret) {
+                RetValue = *Ret;
+                return;
+            }
+        }
 
+        if (!Options.ServerSocket.empty()) {
+            RetValue = runServer(Options.ServerSocket, Caches);
+            return;
+        }
 
-    init();
+        if (!Options.TargetsFName.empty()) {
+            RetValue = buildTargets(Options.TargetsFName, options::argsWithout(argc, argv, "targets"s), Caches);
+            return;
+        }
 
-    assemble(RetValue);
+        init();
+
+        assemble(RetValue);
+    } catch (const AssemblyAborted &E) {
+        // Nothing may be left running or open for the next assembly in the
+        // process. The saves done so far still report their messages, up
+        // to a fatal one of them, at their own lines even when the abort came
+        // from a LUA block.
+        LuaLine = -1;
+        try {
+            Saves.finish();
+        } catch (const AssemblyAborted &) {
+        }
+        flushOutputFiles();
+        shutdownLUA();
+        delete Exports;
+        Exports = nullptr;
+        RetValue = E.ExitCode;
+    }
+}
+
+extern thread_local Assembler *Asm; // FIXME: errors.cpp
+
+Assembler::~Assembler() {
+    // The members left are destroyed without an assembler for messages
+    if (Asm == this) {
+        initLegacyErrorHandler(nullptr);
+    }
 }
 
 void initLegacyParser(); // FIXME
@@ -155,6 +261,8 @@ void Assembler::initPass(int P) {
     Labels.init();
     pass = P;
     Em.reset();
+    Em.clearMemory();
+    Em.setSizingPass(P != LASTPASS);
     enableSourceReader();
     CurrentGlobalLine = CurrentLocalLine = CompiledCurrentLine = 0;
     Listing.initPass();
@@ -169,11 +277,14 @@ void Assembler::initPass(int P) {
     Defines.set("_RELEASE"s, "0"s);
     Defines.set("_ERRORS"s, "0"s);
     Defines.set("_WARNINGS"s, "0"s);
+    for (const auto &D : Options.CmdLineDefines) {
+        Defines.set(D.first, D.second);
+    }
 }
 
 template<typename T>
 void Assembler::msg(const T S) {
-    cerr << S << endl;
+    errorStream() << S << endl;
 }
 
 void Assembler::exitFail(const std::string &Msg) {
@@ -199,7 +310,7 @@ void Assembler::openTopLevelFile(const fs::path &FileName, bool PerFileExports)
     }
 }
 
-extern fs::ifstream *pIFS; // FIXME
+extern thread_local CachedFileStream *pIFS; // FIXME
 void clearReadLineBuf(); // FIXME
 extern void readBufLine(bool Parse = true, bool SplitByColon = true); // FIXME
 void checkRepeatStackAtEOF(); // FIXME
@@ -213,7 +324,7 @@ void Assembler::openFile(const fs::path &FileName) {
 
     if (++IncludeLevel > 20) Fatal("Over 20 files nested");
 
-    pIFS->open(FileName, std::ios::binary);
+    pIFS->open(Files, FileName);
     if (pIFS->fail()) {
         Fatal("Error opening file "s + FileName.string(), strerror(errno));
     }
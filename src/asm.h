@@ -4,6 +4,7 @@
 #include <string>
 
 #include "fs.h"
+#include "filecache.h"
 #include "options.h"
 #include "codeemitter.h"
 #include "labels.h"
@@ -12,24 +13,37 @@
 #include "asm/export.h"
 #include "asm/struct.h"
 #include "listing.h"
+#include "srcmap.h"
+#include "saves.h"
+#include "packers.h"
+#include "profiler.h"
 #include "modules.h"
 
 using namespace std::string_literals;
 
+// Caches which outlive an assembly, shared by the assemblies of --targets
+struct AssemblerCaches {
+    FileCache Files;
+    PackCache Packs;
+};
+
 class Assembler {
 public:
     Assembler() = delete;
 
-    Assembler(int argc, char *argv[], int &RetValue);
+    Assembler(int argc, char *argv[], int &RetValue,
+              std::shared_ptr<AssemblerCaches> _Caches = std::make_shared<AssemblerCaches>());
+
+    ~Assembler();
 
     void initPass(int P);
 
     template<typename T>
     void msg(T S);
 
-    static void exitFail() { std::exit(EXIT_FAILURE); }
+    static void exitFail() { throw AssemblyAborted{EXIT_FAILURE}; }
 
-    void exitSuccess() { std::exit(EXIT_SUCCESS); }
+    void exitSuccess() { throw AssemblyAborted{EXIT_SUCCESS}; }
 
     void exitFail(const std::string &Msg);
 
@@ -55,6 +69,9 @@ public:
         Options.LabelsListFName = F;
     }
 
+    std::shared_ptr<AssemblerCaches> Caches;
+    FileCache &Files;
+    PackCache &Packs;
     CDefines Defines;
     CodeEmitter Em;
     CLabels Labels;
@@ -62,6 +79,9 @@ public:
     CStructs Structs;
     CModules Modules;
     ListingWriter Listing;
+    SourceMapWriter SourceMap;
+    DeferredSaves Saves;
+    Profiler Profile;
     ExportWriter *Exports = nullptr;
 
 private:
@@ -5,9 +5,9 @@
 
 #include "struct.h"
 
-extern int pass; // FIXME
+extern thread_local int pass; // FIXME
 
-std::string PreviousIsLabel;
+thread_local std::string PreviousIsLabel;
 
 void CStruct::copyLabels(CStruct &St) {
     if (St.Labels.empty() || PreviousIsLabel.empty())
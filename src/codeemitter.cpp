@@ -2,18 +2,58 @@
 
 #include "codeemitter.h"
 
-optional<std::string> CodeEmitter::emitByte(uint8_t Byte) {
+optional<std::string> CodeEmitter::checkOverflow() {
     const std::string ErrMsg{"CPU address space overflow"s};
     if (CPUAddrOverflow) {
         return ErrMsg;
     } else if (EmitAddrOverflow) {
         return ErrMsg + " (DISP shift = "s + std::to_string(EmitAddress - CPUAddress) + ")"s;
     }
+    return boost::none;
+}
+
+size_t CodeEmitter::bytesBeforeOverflow(size_t Size) {
+    size_t N = std::min(Size, (size_t) (0x10000 - CPUAddress));
+    if (Disp)
+        N = std::min(N, (size_t) (0x10000 - EmitAddress));
+    return N;
+}
+
+extern thread_local aint CurrentLocalLine; // FIXME
+
+void CodeEmitter::mapSource(size_t Size) {
+    if (!Asm.SourceMap.isActive()) {
+        return;
+    }
+    const auto &File = getCurrentSrcFileNameForMsg().string();
+    int Depth = Asm.Listing.macroDepth();
+    uint16_t Addr = getEmitAddress();
+    if (!MemManager.isActive()) {
+        Asm.SourceMap.add(-1, Addr, Size, File, (uint32_t) CurrentLocalLine, Depth);
+        return;
+    }
+    // Split at slot boundaries as each slot may map a different page
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (0x4000 - (Addr & 0x3fff)));
+        Asm.SourceMap.add(MemManager.getPageForAddress(Addr), Addr, N, File, (uint32_t) CurrentLocalLine, Depth);
+        Addr = (uint16_t) (Addr + N);
+        Size -= N;
+    }
+}
+
+optional<std::string> CodeEmitter::emitByte(uint8_t Byte) {
+    auto Err = checkOverflow();
+    if (Err) return Err;
+    if (SizingPass) {
+        emitSizeOnly(1);
+        return boost::none;
+    }
+    mapSource(1);
     if (MemManager.isActive()) {
         MemManager.writeByte(getEmitAddress(), Byte);
     }
-    if (RawOFS.is_open()) {
-        RawOFS.write((char *)&Byte, 1);
+    if (RawOFS.isOpen()) {
+        RawOFS.put((char) Byte);
     }
     incAddress();
     return boost::none;
@@ -34,6 +74,76 @@ bool CodeEmitter::incAddress() {
     return false;
 }
 
+optional<std::string> CodeEmitter::emitSpan(const uint8_t *Src, size_t Size) {
+    while (Size > 0) {
+        auto Err = checkOverflow();
+        if (Err) return Err;
+        auto N = bytesBeforeOverflow(Size);
+        if (SizingPass) {
+            emitSizeOnly(N);
+            Size -= N;
+            continue;
+        }
+        mapSource(N);
+        if (MemManager.isActive()) {
+            MemManager.writeSpan(getEmitAddress(), Src, N);
+        }
+        if (RawOFS.isOpen()) {
+            RawOFS.write((const char *) Src, N);
+        }
+        incAddress(N);
+        Src += N;
+        Size -= N;
+    }
+    return boost::none;
+}
+
+optional<std::string> CodeEmitter::emitFill(uint8_t Byte, size_t Size) {
+    while (Size > 0) {
+        auto Err = checkOverflow();
+        if (Err) return Err;
+        auto N = bytesBeforeOverflow(Size);
+        if (SizingPass) {
+            emitSizeOnly(N);
+            Size -= N;
+            continue;
+        }
+        mapSource(N);
+        if (MemManager.isActive()) {
+            MemManager.fillSpan(getEmitAddress(), Byte, N);
+        }
+        if (RawOFS.isOpen()) {
+            RawOFS.fill((char) Byte, N);
+        }
+        incAddress(N);
+        Size -= N;
+    }
+    return boost::none;
+}
+
+void CodeEmitter::emitSizeOnly(size_t Size) {
+    if (MemManager.isActive()) {
+        MemManager.markUsed(getEmitAddress(), Size);
+    }
+    incAddress(Size);
+}
+
+// Increase address by Count and return true on overflow
+bool CodeEmitter::incAddress(size_t Count) {
+    bool Overflow = false;
+    if (CPUAddress + Count >= 0x10000) {
+        CPUAddrOverflow = Overflow = true;
+    }
+    CPUAddress = (uint16_t) (CPUAddress + Count);
+    if (Disp) {
+        if (EmitAddress + Count >= 0x10000) {
+            EmitAddrOverflow = Overflow = true;
+        }
+        EmitAddress = (uint16_t) (EmitAddress + Count);
+    }
+    return Overflow;
+}
+
 // DISP directive
 void CodeEmitter::doDisp(uint16_t DispAddress) {
     EmitAddress = CPUAddress;
@@ -59,11 +169,21 @@ void CodeEmitter::setRawOutputOptions(bool EnableOrOverride,
     ForcedOutputDirectory = _ForcedOutputDirectory;
 }
 
-void CodeEmitter::setRawOutput(const fs::path &FileName, OutputMode Mode) {
-    if (RawOFS.is_open()) {
-        RawOFS.close();
+optional<std::string> CodeEmitter::closeRawOutput() {
+    if (RawOFS.isOpen()) {
+        if (!RawOFS.close()) {
+            return "Error writing file: "s + RawOutputFileName.string();
+        }
         enforceFileSize();
     }
+    return boost::none;
+}
+
+void CodeEmitter::setRawOutput(const fs::path &FileName, OutputMode Mode) {
+    auto Err = closeRawOutput();
+    if (Err) {
+        Error(*Err, ALL);
+    }
     auto OpenMode = std::ios_base::binary | std::ios_base::in | std::ios_base::out;
     switch (Mode) {
         case OutputMode::Truncate:
@@ -77,22 +197,25 @@ void CodeEmitter::setRawOutput(const fs::path &FileName, OutputMode Mode) {
     }
     RawOutputEnable = true;
     RawOutputFileName = ForcedOutputDirectory.empty() ? FileName : resolveOutputPath(FileName);
-    RawOFS.open(RawOutputFileName, OpenMode);
+    // With a known final size write through a memory mapping
+    if (ForcedRawOutputSize == 0 || !RawOFS.openMapped(RawOutputFileName, OpenMode, ForcedRawOutputSize)) {
+        RawOFS.open(RawOutputFileName, OpenMode);
+    }
 }
 
 optional<std::string> CodeEmitter::seekRawOutput(std::streamoff Offset, std::ios_base::seekdir Method) {
-    if (RawOFS.is_open()) {
+    if (RawOFS.isOpen()) {
 
         std::streampos NewPos;
         if (Method == std::ios_base::cur) {
-            NewPos = RawOFS.tellp() + Offset;
+            NewPos = RawOFS.tell() + Offset;
         } else {
             NewPos = Offset;
         }
 
-        RawOFS.seekp(Offset, Method);
+        RawOFS.seek(Offset, Method);
 
-        if (RawOFS.tellp() != NewPos) {
+        if (RawOFS.tell() != NewPos) {
             return "Could not seek to position "s + std::to_string(Offset) +
                    " of file "s + RawOutputFileName.string();
         }
@@ -102,7 +225,7 @@ optional<std::string> CodeEmitter::seekRawOutput(std::streamoff Offset, std::ios
 
 void CodeEmitter::enforceFileSize() {
     // File must be closed at this point
-    assert(!RawOFS.is_open());
+    assert(!RawOFS.isOpen());
     if (ForcedRawOutputSize > 0) {
         auto Size = fs::file_size(RawOutputFileName);
         if (ForcedRawOutputSize < Size) {
@@ -125,13 +248,10 @@ fs::path CodeEmitter::resolveOutputPath(const fs::path &p) {
 optional<std::string> CodeEmitter::align(uint16_t Alignment, optional<uint8_t> FillByte) {
     if (Alignment > 0x8000 || Alignment < 2)
         return "Invalid alignment value: "s + std::to_string(Alignment);
-    while (getCPUAddress() % Alignment != 0) {
-        if (FillByte) {
-            auto Err = emitByte(*FillByte);
-            if (Err) return Err;
-        } else {
-            incAddress();
-        }
+    auto Count = (size_t) ((Alignment - getCPUAddress() % Alignment) % Alignment);
+    if (FillByte) {
+        return emitFill(*FillByte, Count);
     }
+    incAddress(Count);
     return boost::none;
 }
@@ -2,6 +2,7 @@
 #define SJASMPLUS_CODEEMITTER_H
 
 #include "memory.h"
+#include "rawoutput.h"
 #include "asm/common.h"
 
 using boost::optional;
@@ -20,6 +21,7 @@ private:
     bool Disp; // DISP flag
     bool CPUAddrOverflow;
     bool EmitAddrOverflow;
+    bool SizingPass = false;
 
     int Slot = -1;
 
@@ -28,12 +30,20 @@ private:
     fs::path RawOutputFileName;
     bool RawOutputEnable = false;
     bool RawOutputOverride = false;
-    fs::fstream RawOFS;
+    RawOutput RawOFS;
     uintmax_t ForcedRawOutputSize = 0;
     fs::path ForcedOutputDirectory;
 
     void enforceFileSize();
 
+    optional<std::string> checkOverflow();
+
+    // Number of bytes which can be emitted before either address wraps around
+    size_t bytesBeforeOverflow(size_t Size);
+
+    // Record the source of Size bytes about to be emitted for the source map
+    void mapSource(size_t Size);
+
 public:
     CodeEmitter() = delete;
     explicit CodeEmitter(Assembler &_Asm) : Asm(_Asm) {
@@ -41,10 +51,7 @@ public:
     }
 
     ~CodeEmitter() {
-        if (RawOFS.is_open()) {
-            RawOFS.close();
-            enforceFileSize();
-        }
+        closeRawOutput();
     }
 
     uint16_t getCPUAddress() {
@@ -57,6 +64,14 @@ public:
 
     optional<std::string> emitByte(uint8_t Byte);
 
+    // Emit a block of bytes, memory and raw output are written in chunks
+    // which do not cross the end of the address space.
+    // Src is not read in a sizing pass and may be null then.
+    optional<std::string> emitSpan(const uint8_t *Src, size_t Size);
+
+    // Emit Size copies of Byte
+    optional<std::string> emitFill(uint8_t Byte, size_t Size);
+
     // ORG directive
     void setAddress(uint16_t NewAddress) {
         if (!Disp) {
@@ -68,9 +83,16 @@ public:
         }
     }
 
+    // Account for Size bytes which are only emitted in the last pass:
+    // advance addresses and mark memory as used, overflow is not reported
+    void emitSizeOnly(size_t Size);
+
     // Increase address and return true on overflow
     bool incAddress();
 
+    // Increase address by Count and return true on overflow
+    bool incAddress(size_t Count);
+
     // DISP directive
     void doDisp(uint16_t DispAddress);
 
@@ -79,6 +101,13 @@ public:
 
     bool isDisp() { return Disp; }
 
+    // In a sizing pass (all but the last one) emitted data is not materialized:
+    // addresses advance, overflow is checked and memory usage is recorded
+    // for unused block searches, but memory contents and raw output are not written
+    void setSizingPass(bool Value) { SizingPass = Value; }
+
+    bool isSizingPass() { return SizingPass; }
+
     optional<std::string> align(uint16_t Alignment, optional<uint8_t> FillByte);
 
     void reset() {
@@ -89,6 +118,9 @@ public:
 
     bool isMemManagerActive() { return MemManager.isActive(); }
 
+    // Reset the contents of all memory models at the start of a pass
+    void clearMemory() { MemManager.clearAll(); }
+
     void setMemModel(const std::string &Name) {
         MemManager.setMemModel(Name);
         Slot = MemManager.defaultSlot();
@@ -133,14 +165,18 @@ public:
         return MemManager.getPageForAddress(getEmitAddress());
     }
 
+    int getPageForAddress(uint16_t Addr) {
+        return MemManager.getPageForAddress(Addr);
+    }
+
     uint8_t getByte(uint16_t Addr) {
         uint8_t Byte;
-        getBytes(&Byte, Addr, 1);
+        readSpan(&Byte, Addr, 1);
         return Byte;
     }
 
-    void getBytes(uint8_t *Dest, uint16_t Addr, uint16_t Size) {
-        MemManager.getBytes(Dest, Addr, Size);
+    void readSpan(uint8_t *Dest, uint16_t Addr, size_t Size) {
+        MemManager.readSpan(Dest, Addr, Size);
     }
 
     void getBytes(uint8_t *Dest, int Slot, uint16_t AddrInPage, uint16_t Size) {
@@ -165,6 +201,9 @@ public:
 
     void setRawOutput(const fs::path &FileName, OutputMode Mode = OutputMode::Truncate);
 
+    // Error string if the file could not be written completely
+    optional<std::string> closeRawOutput();
+
     bool isRawOutputEnabled() { return RawOutputEnable; }
 
     bool isRawOutputOverriden() { return RawOutputOverride; }
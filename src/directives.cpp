@@ -56,12 +56,12 @@ using boost::algorithm::to_upper_copy;
 using namespace std::string_literals;
 
 // FIXME: errors.cpp
-extern Assembler *Asm;
+extern thread_local Assembler *Asm;
 
-int StartAddress = -1;
+thread_local int StartAddress = -1;
 
-FunctionTable DirectivesTable;
-FunctionTable DirectivesTable_dup;
+thread_local FunctionTable DirectivesTable;
+thread_local FunctionTable DirectivesTable_dup;
 
 /*
  * Use this function for now
@@ -541,9 +541,23 @@ void dirSIZE() {
     Asm->Em.setForcedRawOutputFileSize(val);
 }
 
+// Packer name after the other arguments of INCBIN and SAVEBIN
+bool getPacker(const std::string &Name, optional<packers::Method> &Packer, int Type) {
+    auto Id = getID(lp);
+    if (Id) {
+        Packer = packers::find(*Id);
+    }
+    if (!Packer) {
+        Error("["s + Name + "] Unknown packer, zx0 or lz4 expected"s, bp, Type);
+        return false;
+    }
+    return true;
+}
+
 void dirINCBIN() {
     aint val;
     int offset = -1, length = -1;
+    optional<packers::Method> Packer;
 
     const fs::path &FileName = getFileName(lp);
     if (comma(lp)) {
@@ -568,11 +582,18 @@ void dirINCBIN() {
                 return;
             }
             length = val;
+            if (comma(lp) && !getPacker("INCBIN"s, Packer, ALL)) {
+                return;
+            }
         }
     }
     offset = offset < 0 ? 0 : offset;
     length = length < 0 ? 0 : length;
-    includeBinaryFile(FileName, offset, length);
+    if (Packer) {
+        includePackedFile(FileName, offset, length, *Packer);
+    } else {
+        includeBinaryFile(FileName, offset, length);
+    }
 }
 
 void dirINCHOB() {
@@ -609,6 +630,7 @@ void dirINCHOB() {
 
     //used for implicit format check
     fnaamh = resolveIncludeFilename(FileName);
+    flushOutputFiles();
     fs::ifstream IFSH(fnaamh, std::ios::binary);
     if (IFSH.fail()) {
         Fatal("[INCHOB] Error opening file "s + FileName.string() + ": "s + strerror(errno));
@@ -671,6 +693,7 @@ void dirINCTRD() {
     //TODO: extract code to io_trd
     // open TRD
     fs::path fnaamh2 = resolveIncludeFilename(FileName);
+    flushOutputFiles();
     fs::ifstream ifs;
     ifs.open(fnaamh2, std::ios_base::binary);
     if (ifs.fail()) {
@@ -713,9 +736,22 @@ void dirINCTRD() {
     includeBinaryFile(FileName, offset, length);
 }
 
-void dirSAVESNA() {
+// Write the file now or, with --defer-saves, queue it with a snapshot of the
+// memory. Save gets the memory and the source line for messages.
+void saveOutputFile(const fs::path &FileName, std::function<void(MemModel &, const std::string &)> Save) {
+    if (!Asm->Saves.isEnabled()) {
+        Save(Asm->Em.getMemModel(), bp);
+        return;
+    }
+    auto Mem = Asm->Em.getMemModel().snapshot();
+    const std::string Line{bp};
+    Asm->Saves.add(FileName, [Mem, Line, Save] { Save(*Mem, Line); });
+}
+
+// SAVESNA, SAVEZ80 and SAVESZX <file>[,<start>]
+void saveSnapshot(const std::string &Name, bool (*Save)(MemModel &, const fs::path &, uint16_t)) {
     if (!Asm->Em.isMemManagerActive()) {
-        Error("[SAVESNA] works in device emulation mode only"s);
+        Error("["s + Name + "] works in device emulation mode only"s);
         return;
     }
     bool exec = true;
@@ -730,31 +766,46 @@ void dirSAVESNA() {
     if (comma(lp)) {
         if (!comma(lp) && StartAddress < 0) {
             if (!parseExpression(lp, val)) {
-                Error("[SAVESNA] Syntax error"s, bp, PASS3);
+                Error("["s + Name + "] Syntax error"s, bp, PASS3);
                 return;
             }
             if (val < 0) {
-                Error("[SAVESNA] Negative values are not allowed"s, bp, PASS3);
+                Error("["s + Name + "] Negative values are not allowed"s, bp, PASS3);
                 return;
             }
             start = val;
         } else {
-            Error("[SAVESNA] Syntax error. No parameters"s, bp, PASS3);
+            Error("["s + Name + "] Syntax error. No parameters"s, bp, PASS3);
             return;
         }
     } else if (StartAddress < 0) {
-        Error("[SAVESNA] Syntax error. No parameters"s, bp, PASS3);
+        Error("["s + Name + "] Syntax error. No parameters"s, bp, PASS3);
         return;
     } else {
         start = StartAddress;
     }
 
-    if (exec && !zx::saveSNA(Asm->Em.getMemModel(), FileName, start)) {
-        Error("[SAVESNA] Error writing file (Disk full?)"s, bp, CATCHALL);
-        return;
+    if (exec) {
+        saveOutputFile(FileName, [Name, Save, FileName, start](MemModel &M, const std::string &Line) {
+            if (!Save(M, FileName, start)) {
+                Error("["s + Name + "] Error writing file (Disk full?)"s, Line, CATCHALL);
+            }
+        });
     }
 }
 
+void dirSAVESNA() {
+    saveSnapshot("SAVESNA"s, zx::saveSNA);
+}
+
+void dirSAVEZ80() {
+    saveSnapshot("SAVEZ80"s, zx::saveZ80);
+}
+
+void dirSAVESZX() {
+    saveSnapshot("SAVESZX"s, zx::saveSZX);
+}
+
 void dirSAVETAP() {
     if (!Asm->Em.isMemManagerActive()) {
         Error("[SAVETAP] works in device emulation mode only"s);
@@ -793,10 +844,106 @@ void dirSAVETAP() {
         start = StartAddress;
     }
 
-    if (exec && !zx::saveTAP(Asm->Em.getMemModel(), FileName, start)) {
-        Error("[SAVETAP] Error writing file (Disk full?)"s, bp, CATCHALL);
+    if (exec) {
+        saveOutputFile(FileName, [FileName, start](MemModel &M, const std::string &Line) {
+            if (!zx::saveTAP(M, FileName, start)) {
+                Error("[SAVETAP] Error writing file (Disk full?)"s, Line, CATCHALL);
+            }
+        });
+    }
+}
+
+void dirEMPTYTAP() {
+    if (!Asm->Em.isMemManagerActive()) {
+        Error("[EMPTYTAP] works in device emulation mode only"s);
         return;
     }
+    if (pass != LASTPASS) {
+        skipArg(lp);
+        return;
+    }
+    const fs::path &FileName = Asm->Em.resolveOutputPath(getFileName(lp));
+    if (FileName.empty()) {
+        Error("[EMPTYTAP] Syntax error"s, bp, CATCHALL);
+        return;
+    }
+    if (Asm->Saves.isEnabled()) {
+        Asm->Saves.add(FileName, [FileName] { zx::emptyTAP(FileName); });
+    } else {
+        zx::emptyTAP(FileName);
+    }
+}
+
+// SAVETAPBLOCK <file>,<name>,<start>,<length>[,<page>]
+// Appends a code block to a tape, headerless if name is empty. With a page
+// start is an address in slot 3 read from that page.
+void dirSAVETAPBLOCK() {
+    if (!Asm->Em.isMemManagerActive()) {
+        Error("[SAVETAPBLOCK] works in device emulation mode only"s);
+        return;
+    }
+    aint val;
+    int start, length, page = -1;
+
+    const fs::path &FileName = Asm->Em.resolveOutputPath(getFileName(lp));
+    if (!comma(lp)) {
+        Error("[SAVETAPBLOCK] Syntax error. No parameters"s, bp, PASS3);
+        return;
+    }
+    const std::string Name = getString(lp);
+    if (Name.size() > 10) {
+        Error("[SAVETAPBLOCK] Names on tape are limited to 10 characters"s, bp, PASS3);
+        return;
+    }
+    if (!comma(lp) || !parseExpression(lp, val)) {
+        Error("[SAVETAPBLOCK] Syntax error"s, bp, PASS3);
+        return;
+    }
+    if (val < 0 || val > 0xFFFF) {
+        Error("[SAVETAPBLOCK] Start address should be between 0000h and FFFFh"s, bp, PASS3);
+        return;
+    }
+    start = val;
+    if (!comma(lp) || !parseExpression(lp, val)) {
+        Error("[SAVETAPBLOCK] Syntax error"s, bp, PASS3);
+        return;
+    }
+    // The block length on tape also counts the flag and checksum bytes
+    if (val > 0xFFFE) {
+        Error("[SAVETAPBLOCK] Blocks are limited to 65534 bytes"s, bp, PASS3);
+        return;
+    }
+    if (val <= 0 || start + val > 0x10000) {
+        Error("[SAVETAPBLOCK] Block does not fit in the address space"s, bp, PASS3);
+        return;
+    }
+    length = val;
+    if (comma(lp)) {
+        if (!parseExpression(lp, val)) {
+            Error("[SAVETAPBLOCK] Syntax error"s, bp, PASS3);
+            return;
+        }
+        if (!Asm->Em.isPagedMemory() || val < 0 || val >= Asm->Em.getMemModel().getNumMemPages()) {
+            Error("[SAVETAPBLOCK] No such page"s, bp, PASS3);
+            return;
+        }
+        if (start < 0xC000) {
+            Error("[SAVETAPBLOCK] A block from a page should be in slot 3 (C000h-FFFFh)"s, bp, PASS3);
+            return;
+        }
+        page = val;
+    }
+    if (pass != LASTPASS) {
+        return;
+    }
+    saveOutputFile(FileName, [FileName, Name, start, length, page](MemModel &M, const std::string &Line) {
+        bool Ok = page < 0 ?
+                  zx::addTAPBlock(M, FileName, Name, start, length, -1, start) :
+                  zx::addTAPBlock(M, FileName, Name, start - 0xC000, length, page, start);
+        if (!Ok) {
+            Error("[SAVETAPBLOCK] Error writing file (Disk full?)"s, Line, CATCHALL);
+        }
+    });
 }
 
 void dirSAVEBIN() {
@@ -812,6 +959,7 @@ void dirSAVEBIN() {
 
     aint val;
     int start = -1, length = -1;
+    optional<packers::Method> Packer;
 
     const fs::path &FileName = Asm->Em.resolveOutputPath(getFileName(lp));
     if (comma(lp)) {
@@ -842,15 +990,26 @@ void dirSAVEBIN() {
                 return;
             }
             length = val;
+            if (comma(lp) && !getPacker("SAVEBIN"s, Packer, PASS3)) {
+                return;
+            }
         }
     } else {
         Error("[SAVEBIN] Syntax error. No parameters"s, bp, PASS3);
         return;
     }
 
-    if (exec && !saveBinaryFile(FileName, start, length)) {
-        Error("[SAVEBIN] Error writing file (Disk full?)"s, bp, CATCHALL);
-        return;
+    if (exec) {
+        saveOutputFile(FileName, [FileName, start, length, Packer](MemModel &M, const std::string &Line) {
+            if (Packer) {
+                auto Err = savePackedFile(M, FileName, start, length, *Packer);
+                if (Err) {
+                    Error("[SAVEBIN] "s + *Err, Line, CATCHALL);
+                }
+            } else if (!saveBinaryFile(M, FileName, start, length)) {
+                Error("[SAVEBIN] Error writing file (Disk full?)"s, Line, CATCHALL);
+            }
+        });
     }
 }
 
@@ -914,9 +1073,12 @@ void dirSAVEHOB() {
         Error("[SAVEHOB] Syntax error. No parameters"s, bp, PASS3);
         return;
     }
-    if (exec && !SaveHobeta(FileName, HobetaFileName, start, length)) {
-        Error("[SAVEHOB] Error writing file (Disk full?)"s, bp, CATCHALL);
-        return;
+    if (exec) {
+        saveOutputFile(FileName, [FileName, HobetaFileName, start, length](MemModel &M, const std::string &Line) {
+            if (!SaveHobeta(M, FileName, HobetaFileName, start, length)) {
+                Error("[SAVEHOB] Error writing file (Disk full?)"s, Line, CATCHALL);
+            }
+        });
     }
 }
 
@@ -934,7 +1096,12 @@ void dirEMPTYTRD() {
         Error("[EMPTYTRD] Syntax error"s, bp, CATCHALL);
         return;
     }
-    TRD_SaveEmpty(FileName);
+    if (Asm->Saves.isEnabled()) {
+        // Keep the order with SAVETRD to the same image
+        Asm->Saves.add(FileName, [FileName] { TRD_SaveEmpty(FileName); });
+    } else {
+        TRD_SaveEmpty(FileName);
+    }
 }
 
 void dirSAVETRD() {
@@ -1013,7 +1180,10 @@ void dirSAVETRD() {
     }
 
     if (exec) {
-        TRD_AddFile(FileName, HobetaFileName, start, length, autostart);
+        saveOutputFile(FileName, [FileName, HobetaFileName, start, length, autostart](MemModel &M,
+                                                                                    const std::string &) {
+            TRD_AddFile(M, FileName, HobetaFileName, start, length, autostart);
+        });
     }
 }
 
@@ -1590,6 +1760,8 @@ void dirSHELLEXEC() {
     const std::string &command = getString(lp);
     const std::string &parameters = comma(lp) ? getString(lp) : ""s;
     if (pass == LASTPASS) {
+        // The command may use files written by SAVE* directives
+        flushOutputFiles();
         const std::string log{command + ' ' + parameters};
         _COUT "Executing " _CMDL log _ENDL;
 #if defined(WIN32)
@@ -1835,7 +2007,9 @@ void _lua_showerror() {
     int ln;
 
     std::string LuaErr{lua_tostring(LUA, -1)};
-    LuaErr = LuaErr.substr(18);
+    // Skip the chunk name, [string "script <position>"]:
+    auto NameEnd = LuaErr.find("\"]:"s);
+    LuaErr = NameEnd == std::string::npos ? LuaErr.substr(18) : LuaErr.substr(NameEnd + 3);
     ln = std::stoi(LuaErr.substr(0, LuaErr.find(":"s))) + LuaLine;
 
     ErrorStr = getCurrentSrcFileNameForMsg().string() + "("s + std::to_string(ln) + "): error: [LUA]:"s + LuaErr;
@@ -1856,40 +2030,14 @@ void _lua_showerror() {
     lua_pop(LUA, 1);
 }
 
-typedef struct luaMemFile {
-    const char *text;
-    size_t size;
-} luaMemFile;
-
-const char *readMemFile(lua_State *, void *ud, size_t *size) {
-    // Convert the ud pointer (UserData) to a pointer of our structure
-    auto *luaMF = (luaMemFile *) ud;
-
-    // Are we done?
-    if (luaMF->size == 0)
-        return nullptr;
-
-    // Read everything at once
-    // And set size to zero to tell the next call we're done
-    *size = luaMF->size;
-    luaMF->size = 0;
-
-    // Return a pointer to the readed text
-    return luaMF->text;
-}
-
 void dirLUA() {
     int error;
     const char *rp;
     optional<std::string> Id;
-    auto *buff = new char[32768];
-    char *bp = buff;
-//    char size = 0;
+    std::string Script;
     int ln = 0;
     bool execute = false;
 
-    luaMemFile luaMF;
-
     skipWhiteSpace(lp);
 
     if ((Id = getID(lp))) {
@@ -1926,29 +2074,16 @@ void dirLUA() {
         rp = line;
         skipWhiteSpace(rp);
         if (cmpHStr(rp, "endlua")) {
-            if (execute) {
-                if ((bp - buff) + (rp - lp - 6) < 32760 && (rp - lp - 6) > 0) {
-                    STRNCPY(bp, 32768 - (bp - buff) + 1, lp, rp - lp - 6);
-                    bp += rp - lp - 6;
-                    *(bp++) = '\n';
-                    *(bp) = 0;
-                } else {
-                    delete[] buff;
-                    Fatal("[LUA] Maximum size of Lua script is 32768 bytes"s);
-                }
+            if (execute && rp - lp - 6 > 0) {
+                Script.append(lp, rp - lp - 6);
+                Script += '\n';
             }
             lp = (char *) rp;
             break;
         }
         if (execute) {
-            if ((bp - buff) + strlen(lp) < 32760) {
-                STRCPY(bp, 32768 - (bp - buff) + 1, lp);
-                bp += strlen(lp);
-                *(bp++) = '\n';
-                *(bp) = 0;
-            } else {
-                Fatal("[LUA] Maximum size of Lua script is 32768 bytes"s);
-            }
+            Script += lp;
+            Script += '\n';
         }
 
         Asm->Listing.listLineSkip(line);
@@ -1956,18 +2091,15 @@ void dirLUA() {
 
     if (execute) {
         LuaLine = ln;
-        luaMF.text = buff;
-        luaMF.size = strlen(luaMF.text);
-        error = lua_load(LUA, readMemFile, &luaMF, "script") || lua_pcall(LUA, 0, 0, 0);
-        //error = luaL_loadbuffer(LUA, (char*)buff, sizeof(buff), "script") || lua_pcall(LUA, 0, 0, 0);
-        //error = luaL_loadstring(LUA, buff) || lua_pcall(LUA, 0, 0, 0);
+        auto Position = getCurrentSrcFileNameForMsg().string() + ":"s + std::to_string(ln);
+        Asm->Profile.beginLuaBlock(Position);
+        error = loadLuaChunk(Position, Script) || lua_pcall(LUA, 0, 0, 0);
+        Asm->Profile.endLuaBlock();
         if (error) {
             _lua_showerror();
         }
         LuaLine = -1;
     }
-
-    delete[] buff;
 }
 
 void dirENDLUA() {
@@ -1988,7 +2120,9 @@ void dirINCLUDELUA() {
     }
 
     LuaLine = CurrentLocalLine;
+    Asm->Profile.beginLuaBlock(FileName.string());
     error = luaL_loadfile(LUA, FileName.string().c_str()) || lua_pcall(LUA, 0, 0, 0);
+    Asm->Profile.endLuaBlock();
     if (error) {
         _lua_showerror();
     }
@@ -2007,7 +2141,11 @@ void dirDEVICE() {
 
 }
 
+// Also resets the state of the directives for a new assembly
 void InsertDirectives() {
+    StartAddress = -1;
+    DirectivesTable.clear();
+    DirectivesTable_dup.clear();
     DirectivesTable.insertDirective("assert"s, dirASSERT);
     DirectivesTable.insertDirective("byte"s, dirBYTE);
     DirectivesTable.insertDirective("abyte"s, dirABYTE);
@@ -2034,7 +2172,11 @@ void InsertDirectives() {
     DirectivesTable.insertDirective("inctrd"s, dirINCTRD); /* added */
     DirectivesTable.insertDirective("insert"s, dirINCBIN); /* added */
     DirectivesTable.insertDirective("savesna"s, dirSAVESNA); /* added */
+    DirectivesTable.insertDirective("savez80"s, dirSAVEZ80);
+    DirectivesTable.insertDirective("saveszx"s, dirSAVESZX);
     DirectivesTable.insertDirective("savetap"s, dirSAVETAP); /* added */
+    DirectivesTable.insertDirective("emptytap"s, dirEMPTYTAP);
+    DirectivesTable.insertDirective("savetapblock"s, dirSAVETAPBLOCK);
     DirectivesTable.insertDirective("savehob"s, dirSAVEHOB); /* added */
     DirectivesTable.insertDirective("savebin"s, dirSAVEBIN); /* added */
     DirectivesTable.insertDirective("emptytrd"s, dirEMPTYTRD); /* added */
@@ -2116,3 +2258,56 @@ bool LuaSetSlot(aint n) {
     }
     return true;
 }
+
+bool LuaIsUnusedBlock(aint Start, aint Size) {
+    if (!Asm->Em.isMemManagerActive()) {
+        Error("sj.is_unused_block: no memory model selected"s, lp, CATCHALL);
+        return false;
+    }
+    return Asm->Em.getMemModel().isUnusedBlock((uint16_t) Start, (uint16_t) Size);
+}
+
+int LuaFindUnusedBlock(aint Start, aint Size, aint SearchLimit, bool Backwards) {
+    if (!Asm->Em.isMemManagerActive()) {
+        Error("sj.find_unused_block: no memory model selected"s, lp, CATCHALL);
+        return -1;
+    }
+    auto Res = Asm->Em.getMemModel().findUnusedBlock((uint16_t) Start, (uint16_t) Size,
+                                                     (uint16_t) SearchLimit, Backwards);
+    return Res ? (int) *Res : -1;
+}
+
+// Address range of sj.get_bytes and sj.fill, wrapping around like the emitter
+bool checkLuaRange(const std::string &Name, aint Start, aint Size) {
+    if (!Asm->Em.isMemManagerActive()) {
+        Error(Name + ": no memory model selected"s, lp, CATCHALL);
+        return false;
+    }
+    if (Start < 0 || Start > 0xFFFF || Size < 0 || Size > 0x10000) {
+        Error(Name + ": address or size out of range"s, lp, CATCHALL);
+        return false;
+    }
+    return true;
+}
+
+std::string LuaGetBytes(aint Start, aint Size) {
+    if (!checkLuaRange("sj.get_bytes"s, Start, Size)) {
+        return ""s;
+    }
+    std::string Bytes((size_t) Size, '\0');
+    if (pass == LASTPASS) {
+        Asm->Em.readSpan((uint8_t *) &Bytes[0], (uint16_t) Start, (size_t) Size);
+    }
+    return Bytes;
+}
+
+void LuaFill(aint Start, aint Size, aint Byte) {
+    if (!checkLuaRange("sj.fill"s, Start, Size)) {
+        return;
+    }
+    if (pass == LASTPASS) {
+        Asm->Em.getMemModel().fillSpan((uint16_t) Start, (uint8_t) Byte, (size_t) Size);
+    } else {
+        Asm->Em.getMemModel().markUsed((uint16_t) Start, (size_t) Size);
+    }
+}
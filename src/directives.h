@@ -31,7 +31,7 @@
 
 #include "tables.h"
 
-extern FunctionTable DirectivesTable;
+extern thread_local FunctionTable DirectivesTable;
 
 void InsertDirectives();
 
@@ -41,4 +41,15 @@ bool LuaSetPage(aint n);
 
 bool LuaSetSlot(aint n);
 
+bool LuaIsUnusedBlock(aint Start, aint Size);
+
+// Returns the block address or -1 if there is no unused block
+int LuaFindUnusedBlock(aint Start, aint Size, aint SearchLimit, bool Backwards);
+
+// Memory contents, zeros before the last pass like sj.get_byte
+std::string LuaGetBytes(aint Start, aint Size);
+
+// Set memory without emitting, the memory is marked as used
+void LuaFill(aint Start, aint Size, aint Byte);
+
 #endif // SJASMPLUS_DIRECTIVES_H
@@ -11,20 +11,48 @@ extern "C" {
 #include "errors.h"
 
 // Temporary:
-Assembler *Asm;
+thread_local Assembler *Asm;
 
+thread_local std::string ErrorStr;
+thread_local bool IsSkipErrors;
+thread_local int PreviousErrorLine = -1;
+
+thread_local int WarningCount = 0;
+
+thread_local fs::path CurrentSrcFileNameForMsg;
+
+// The assembler of the calling thread, with a clean error state
 void initLegacyErrorHandler(Assembler *_Asm) {
     Asm = _Asm;
+    ErrorStr.clear();
+    IsSkipErrors = false;
+    PreviousErrorLine = -1;
+    WarningCount = 0;
+    CurrentSrcFileNameForMsg.clear();
 }
 //
 
-std::string ErrorStr;
-bool IsSkipErrors;
-int PreviousErrorLine = -1;
+thread_local std::vector<Diagnostic> *CapturedDiagnostics = nullptr;
 
-int WarningCount = 0;
+thread_local std::ostream *RedirectedMessages = nullptr;
+thread_local std::ostream *RedirectedErrors = nullptr;
 
-fs::path CurrentSrcFileNameForMsg;
+void redirectMessages(std::ostream *To, std::ostream *ErrorsTo) {
+    RedirectedMessages = To;
+    RedirectedErrors = ErrorsTo ? ErrorsTo : To;
+}
+
+std::ostream &messageStream() {
+    return RedirectedMessages ? *RedirectedMessages : cout;
+}
+
+std::ostream &errorStream() {
+    return RedirectedErrors ? *RedirectedErrors : cerr;
+}
+
+void captureDiagnostics(std::vector<Diagnostic> *To) {
+    CapturedDiagnostics = To;
+}
 
 void setCurrentSrcFileNameForMsg(const fs::path &F) {
     CurrentSrcFileNameForMsg = F;
@@ -37,6 +65,14 @@ fs::path &getCurrentSrcFileNameForMsg() {
 void Error(const std::string &fout, const std::string &bd, int type) {
     lua_Debug ar;
 
+    if (CapturedDiagnostics) {
+        CapturedDiagnostics->push_back({true, fout, bd, type});
+        if (type == FATAL) {
+            throw FatalDiagnostic{};
+        }
+        return;
+    }
+
     if (IsSkipErrors && PreviousErrorLine == CurrentLocalLine && type != FATAL) {
         return;
     }
@@ -56,7 +92,10 @@ void Error(const std::string &fout, const std::string &bd, int type) {
     PreviousErrorLine = CurrentLocalLine;
     ++ErrorCount;
 
-    Asm->Defines.set("_ERRORS"s, std::to_string(ErrorCount));
+    // No assembler yet while the options are parsed
+    if (Asm) {
+        Asm->Defines.set("_ERRORS"s, std::to_string(ErrorCount));
+    }
 
     /*SPRINTF3(ep, LINEMAX2, "%s line %lu: %s", filename, CurrentLocalLine, fout);
     if (bd) {
@@ -66,7 +105,7 @@ void Error(const std::string &fout, const std::string &bd, int type) {
         STRCAT(ep, LINEMAX2, "\n");
     }*/
 
-    if (pass > LASTPASS) {
+    if (pass < 1 || pass > LASTPASS) {
         ErrorStr = "error: "s + fout;
     } else {
         int ln;
@@ -87,13 +126,18 @@ void Error(const std::string &fout, const std::string &bd, int type) {
     ErrorStr += "\n"s;
 //    }
 
-    Asm->Listing.write(ErrorStr);
+    if (Asm) {
+        Asm->Listing.write(ErrorStr);
+    }
 
     _COUT ErrorStr _END;
 
     /*if (type==FATAL) exit(1);*/
     if (type == FATAL) {
-        exit(1);
+        if (Asm) {
+            Asm->Listing.flush();
+        }
+        throw AssemblyAborted{EXIT_FAILURE};
     }
 }
 
@@ -114,6 +158,11 @@ void Fatal(const std::string &errstr, const std::string &bd) {
 void Warning(const std::string &fout, const std::string &bd, int type) {
     lua_Debug ar;
 
+    if (CapturedDiagnostics) {
+        CapturedDiagnostics->push_back({false, fout, bd, type});
+        return;
+    }
+
     if (type == PASS1 && pass != 1) {
         return;
     }
@@ -122,9 +171,11 @@ void Warning(const std::string &fout, const std::string &bd, int type) {
     }
 
     ++WarningCount;
-    Asm->Defines.set("_WARNINGS"s, std::to_string(WarningCount));
+    if (Asm) {
+        Asm->Defines.set("_WARNINGS"s, std::to_string(WarningCount));
+    }
 
-    if (pass > LASTPASS) {
+    if (pass < 1 || pass > LASTPASS) {
         ErrorStr = "warning: "s + fout;
     } else {
         int ln;
@@ -145,7 +196,9 @@ void Warning(const std::string &fout, const std::string &bd, int type) {
     ErrorStr += "\n"s;
 //    }
 
-    Asm->Listing.write(ErrorStr);
+    if (Asm) {
+        Asm->Listing.write(ErrorStr);
+    }
     _COUT ErrorStr _END;
 }
 
@@ -8,6 +8,7 @@
 #include <string>
 #include <iostream>
 #include <stack>
+#include <vector>
 
 #include "fs.h"
 
@@ -19,10 +20,10 @@ using std::endl;
 using std::flush;
 using std::stack;
 
-extern std::string ErrorStr;
-extern int PreviousErrorLine;
+extern thread_local std::string ErrorStr;
+extern thread_local int PreviousErrorLine;
 
-extern int WarningCount;
+extern thread_local int WarningCount;
 
 enum EStatus {
     ALL, PASS1, PASS2, PASS3, FATAL, CATCHALL, SUPPRESS
@@ -47,8 +48,38 @@ void Warning(const std::string &fout, const std::string &bd, int type = PASS2);
 
 void Warning(const std::string &fout, int type = PASS2);
 
+// An Error() or Warning() call on a worker thread, reported later
+struct Diagnostic {
+    bool IsError;
+    std::string Message;
+    std::string Detail;
+    int Type;
+};
+
+// Thrown instead of exiting on a FATAL error while capturing
+struct FatalDiagnostic {};
+
+// Thrown instead of exiting the process on a FATAL error and by sj.exit, so
+// that other assemblies in the process go on. The Assembler returns ExitCode.
+struct AssemblyAborted {
+    int ExitCode;
+};
+
+// Collect messages of the calling thread into To instead of reporting them,
+// nullptr to report them again
+void captureDiagnostics(std::vector<Diagnostic> *To);
+
+// Messages go to cout and cerr, or to To and ErrorsTo (To if nullptr) on the
+// calling thread (--targets prints the messages of each target together,
+// --server sends them to the client), nullptr to restore
+void redirectMessages(std::ostream *To, std::ostream *ErrorsTo = nullptr);
+
+std::ostream &messageStream();
+
+std::ostream &errorStream();
+
 // output
-#define _COUT cout <<
+#define _COUT messageStream() <<
 #define _CMDL  <<
 #define _ENDL << endl
 #define _END ;
@@ -0,0 +1,86 @@
+#include <iterator>
+
+#include "filecache.h"
+
+namespace {
+
+// Modification times have a resolution of up to 2 seconds
+const std::time_t RacyTime = 2;
+
+} // namespace
+
+std::shared_ptr<const std::string> FileCache::read(const fs::path &FileName) {
+    boost::system::error_code EC;
+    auto Size = fs::file_size(FileName, EC);
+    std::time_t Time = EC ? 0 : fs::last_write_time(FileName, EC);
+    if (!EC) {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        auto It = Files.find(FileName);
+        if (It != Files.end() && It->second.Size == Size && It->second.Time == Time) {
+            return It->second.Data;
+        }
+    }
+    fs::ifstream IFS(FileName, std::ios::binary);
+    if (!IFS) {
+        return nullptr;
+    }
+    auto Data = std::make_shared<const std::string>(std::istreambuf_iterator<char>(IFS),
+                                                    std::istreambuf_iterator<char>());
+    if (IFS.bad()) {
+        return nullptr;
+    }
+    if (!EC && Data->size() == Size && std::time(nullptr) - Time > RacyTime) {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        auto It = Files.find(FileName);
+        if (It == Files.end()) {
+            Files.emplace(FileName, File{Size, Time, Data});
+            Order.push_back(FileName);
+        } else {
+            Bytes -= It->second.Data->size();
+            It->second = {Size, Time, Data};
+        }
+        Bytes += Data->size();
+        while (Bytes > MaxBytes && Order.size() > 1) {
+            auto Oldest = Files.find(Order.front());
+            Bytes -= Oldest->second.Data->size();
+            Files.erase(Oldest);
+            Order.pop_front();
+        }
+    }
+    return Data;
+}
+
+optional<fs::path> FileCache::findResolved(const std::string &Key) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto It = Resolved.find(Key);
+    if (It == Resolved.end()) {
+        return boost::none;
+    }
+    return It->second;
+}
+
+void FileCache::addResolved(const std::string &Key, const fs::path &FileName) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Resolved[Key] = FileName;
+}
+
+void FileCache::clearResolved() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Resolved.clear();
+}
+
+void CachedFileStream::open(FileCache &Cache, const fs::path &FileName) {
+    Data = Cache.read(FileName);
+    if (Data) {
+        Buf.set(*Data);
+        clear();
+    } else {
+        Buf.reset();
+        setstate(std::ios::failbit);
+    }
+}
+
+void CachedFileStream::close() {
+    Buf.reset();
+    Data.reset();
+}
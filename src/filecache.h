@@ -0,0 +1,84 @@
+#ifndef SJASMPLUS_FILECACHE_H
+#define SJASMPLUS_FILECACHE_H
+
+#include <ctime>
+#include <deque>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <boost/optional.hpp>
+
+#include "fs.h"
+
+using boost::optional;
+
+// Contents of the source and binary files read by the assembler, so every
+// pass and every assembly in the process (--targets) reads a file once.
+// An entry is used while the size and modification time of the file stay
+// the same. A file modified in the last seconds is not kept, as it could
+// be changed again without a new modification time. The contents kept are
+// limited to MaxBytes, the files read first are dropped first, as a
+// --server keeps them for all its requests.
+//
+// Include file names found in the include directories are kept as well,
+// until clearResolved(). A file added since to a directory searched earlier
+// is not noticed until then, so a --server clears them for each request.
+class FileCache {
+private:
+    struct File {
+        uintmax_t Size;
+        std::time_t Time;
+        std::shared_ptr<const std::string> Data;
+    };
+
+    std::mutex Mutex;
+    std::map<fs::path, File> Files;
+    // Keys of Files, oldest first
+    std::deque<fs::path> Order;
+    size_t Bytes = 0;
+    std::map<std::string, fs::path> Resolved;
+
+public:
+    static const size_t MaxBytes = 64 << 20;
+
+    // nullptr if the file cannot be read
+    std::shared_ptr<const std::string> read(const fs::path &FileName);
+
+    // Key is the name and the directories searched, in order
+    optional<fs::path> findResolved(const std::string &Key);
+
+    void addResolved(const std::string &Key, const fs::path &FileName);
+
+    void clearResolved();
+};
+
+// Input stream over the cached contents of a file
+class CachedFileStream : public std::istream {
+private:
+    class Buffer : public std::streambuf {
+    public:
+        void set(const std::string &Data) {
+            auto *Begin = const_cast<char *>(Data.data());
+            setg(Begin, Begin, Begin + Data.size());
+        }
+
+        void reset() {
+            setg(nullptr, nullptr, nullptr);
+        }
+    };
+
+    Buffer Buf;
+    std::shared_ptr<const std::string> Data;
+
+public:
+    CachedFileStream() : std::istream{&Buf} {}
+
+    // Sets failbit if the file cannot be read
+    void open(FileCache &Cache, const fs::path &FileName);
+
+    void close();
+};
+
+#endif //SJASMPLUS_FILECACHE_H
@@ -1,12 +1,21 @@
 #include "global.h"
 
-const char *lp, *bp;
-char line[LINEMAX];
+thread_local const char *lp, *bp;
+thread_local char line[LINEMAX];
 
-int pass = 0, IsLabelNotFound = 0;
+thread_local int pass = 0, IsLabelNotFound = 0;
 
-aint CurrentGlobalLine = 0, CurrentLocalLine = 0, CompiledCurrentLine = 0;
+thread_local aint CurrentGlobalLine = 0, CurrentLocalLine = 0, CompiledCurrentLine = 0;
 
-int ErrorCount = 0;
+thread_local int ErrorCount = 0;
 
-stack<RepeatInfo> RepeatStack; /* added */
+thread_local stack<RepeatInfo> RepeatStack; /* added */
+
+void resetGlobals() {
+    lp = bp = nullptr;
+    line[0] = 0;
+    pass = IsLabelNotFound = 0;
+    CurrentGlobalLine = CurrentLocalLine = CompiledCurrentLine = 0;
+    ErrorCount = 0;
+    RepeatStack = {};
+}
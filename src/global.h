@@ -7,15 +7,19 @@
 #include "tables.h"
 #include "modules.h"
 
-extern const char *lp, *bp;
-extern char line[LINEMAX];
+extern thread_local const char *lp, *bp;
+extern thread_local char line[LINEMAX];
 
-extern int pass, IsLabelNotFound;
+extern thread_local int pass, IsLabelNotFound;
 
-extern aint CurrentGlobalLine, CurrentLocalLine, CompiledCurrentLine;
+extern thread_local aint CurrentGlobalLine, CurrentLocalLine, CompiledCurrentLine;
 
-extern int ErrorCount;
+extern thread_local int ErrorCount;
 
-extern stack<RepeatInfo> RepeatStack;
+extern thread_local stack<RepeatInfo> RepeatStack;
+
+// The globals above belong to the assembly running on the calling thread,
+// reset them before starting one
+void resetGlobals();
 
 #endif //SJASMPLUS_GLOBAL_H
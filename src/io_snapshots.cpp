@@ -24,27 +24,43 @@
 
 */
 
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <sjasmplus_conf.h>
+#ifdef SJASMPLUS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #include "defines.h"
 #include "errors.h"
+#include "threadpool.h"
 #include "zxspectrum.h"
 
 #include "io_snapshots.h"
 
 namespace zx {
 
-bool saveSNA(MemModel &M, const fs::path &fname, uint16_t start) {
-    unsigned char snbuf[31];
+namespace {
 
-    fs::ofstream ofs;
-    ofs.open(fname, std::ios_base::binary);
-    if (ofs.fail()) {
-        Fatal("Error opening file"s, fname.string());
-    }
+// Registers to start at Start as if called from BASIC, as in the 27-byte SNA
+// header. A 48K SNA has no PC, so it is pushed to the stack unless
+// PCOnStack is false. Writes ephemeral bytes to M, which the caller clears
+// with M.clearEphemerals() after saving.
+struct Registers {
+    uint8_t Sna[27];
+    uint16_t PC;
+    uint16_t SP;
+};
+
+Registers initRegisters(MemModel &M, uint16_t start, bool PCOnStack) {
+    Registers Regs;
+    uint8_t *snbuf = Regs.Sna;
 
     zx::initBasicVars(M);
     zx::initScreenAttrs(M);
 
-    memset(snbuf, 0, sizeof(snbuf));
+    memset(snbuf, 0, sizeof(Regs.Sna));
 
     snbuf[1] = 0x58; //hl'
     snbuf[2] = 0x27; //hl'
@@ -53,6 +69,7 @@ bool saveSNA(MemModel &M, const fs::path &fname, uint16_t start) {
     // Set BC=PC to match ZX Basic's USR behavior
     snbuf[13] = (uint8_t) (start & 0xff); //bc
     snbuf[14] = (uint8_t) (start >> 8); //bc
+    Regs.PC = start;
     if (!M.isPagedMemory()) {
         snbuf[0] = 0x3F; //i
         snbuf[3] = 0x9B; //de'
@@ -71,6 +88,7 @@ bool saveSNA(MemModel &M, const fs::path &fname, uint16_t start) {
         snbuf[22] = 0x00; //af
 
         uint16_t stack;
+        bool PCPushed = true;
 
         if (zx::initDefaultBasicStack(M) &&
                 M.readByte(0xFF2D) == (uint8_t) 0xb1 &&
@@ -81,13 +99,16 @@ bool saveSNA(MemModel &M, const fs::path &fname, uint16_t start) {
             snbuf[23] = 0x2D;// + 16; //sp
             snbuf[24] = 0xFF; //sp
 
-            M.writeByte(0xFF2D + 16, (uint8_t) (start & 0x00FF), true, false);  // pc
-            M.writeByte(0xFF2E + 16, (uint8_t) (start >> 8), true, false);      // pc
+            M.writeWord(0xFF2D + 16, start, true, false);  // pc
 
         } else if ((stack = zx::initMinimalBasicStack(M, 8, start)) != 0) {
             snbuf[23] = (uint8_t) (stack & 0xff); //sp
             snbuf[24] = (uint8_t) (stack >> 8); //sp
 
+        } else if (!PCOnStack) {
+            // Where the SNA would leave it, without overwriting the screen
+            PCPushed = false;
+            Regs.SP = 0x4002;
         } else {
             Warning("[SAVESNA] RAM <0x4000-0x4001> will be overridden due to 48k snapshot imperfect format."s,
                     LASTPASS);
@@ -95,19 +116,41 @@ bool saveSNA(MemModel &M, const fs::path &fname, uint16_t start) {
             snbuf[23] = 0x00; //sp
             snbuf[24] = 0x40; //sp
 
-            M.writeByte(0x4000, (uint8_t) (start & 0x00FF), true, false);  // pc
-            M.writeByte(0x4001, (uint8_t) (start >> 8), true, false);      // pc
+            M.writeWord(0x4000, start, true, false);  // pc
+        }
+        if (PCPushed) {
+            // What RETN does when loading the SNA
+            Regs.SP = (uint16_t) (snbuf[23] + 256 * snbuf[24]);
+            Regs.PC = (uint16_t) (M.readByte(Regs.SP) + 256 * M.readByte((uint16_t) (Regs.SP + 1)));
+            Regs.SP += 2;
         }
     } else {
         uint16_t stack = zx::initMinimalBasicStack(M);
         snbuf[23] = (uint8_t) (stack & 0xff); //sp
         snbuf[24] = (uint8_t) (stack >> 8); //sp
+        Regs.SP = stack;
 
         // snbuf[23] = 0X00; //sp
         // snbuf[24] = 0x60; //sp
     }
     snbuf[25] = 1; //im 1
     snbuf[26] = 7; //border 7
+    return Regs;
+}
+
+} // namespace
+
+bool saveSNA(MemModel &M, const fs::path &fname, uint16_t start) {
+    unsigned char snbuf[31];
+
+    fs::ofstream ofs;
+    ofs.open(fname, std::ios_base::binary);
+    if (ofs.fail()) {
+        Fatal("Error opening file"s, fname.string());
+    }
+
+    const Registers Regs = initRegisters(M, start, true);
+    memcpy(snbuf, Regs.Sna, sizeof(Regs.Sna));
 
     ofs.write((const char *) snbuf, sizeof(snbuf) - 4);
     if (ofs.fail()) {
@@ -184,6 +227,253 @@ bool saveSNA(MemModel &M, const fs::path &fname, uint16_t start) {
     return true;
 }
 
+namespace {
+
+const uint16_t PageSize = 0x4000;
+
+// 16K of the snapshot and its number in the file, Data is nullptr if the
+// page was never written to
+struct SnapshotPage {
+    int Number;
+    const uint8_t *Data;
+};
+
+// Compressed page, or the page itself if compression does not pay off
+struct PageBlock {
+    bool Compressed;
+    std::string Data;
+};
+
+using PageCompressor = PageBlock (*)(const uint8_t *Data);
+
+// 48K: the three pages from 4000h, 128K: pages 0-7
+std::vector<SnapshotPage> snapshotPages(MemModel &M, const int Numbers48K[3], int FirstNumber128K) {
+    std::vector<SnapshotPage> Pages;
+    if (!M.isPagedMemory()) {
+        for (int i = 0; i < 3; i++) {
+            Pages.push_back({Numbers48K[i], M.getPtrToMem() + (i + 1) * PageSize});
+        }
+    } else {
+        for (int i = 0; i < 8; i++) {
+            Pages.push_back({FirstNumber128K + i, M.isPageTouched(i) ? M.getPtrToPage(i) : nullptr});
+        }
+    }
+    return Pages;
+}
+
+// Compress the pages in parallel, untouched pages share one compressed zero page
+std::vector<PageBlock> compressPages(const std::vector<SnapshotPage> &Pages, PageCompressor Compress) {
+    std::vector<PageBlock> Blocks(Pages.size());
+    PageBlock ZeroBlock;
+    {
+        ThreadPool Pool{std::min(ThreadPool::defaultThreads(), (unsigned) Pages.size())};
+        if (std::any_of(Pages.begin(), Pages.end(), [](const SnapshotPage &P) { return !P.Data; })) {
+            Pool.submit([&ZeroBlock, Compress] {
+                static const uint8_t Zeros[PageSize] = {};
+                ZeroBlock = Compress(Zeros);
+            });
+        }
+        for (size_t i = 0; i < Pages.size(); i++) {
+            if (Pages[i].Data) {
+                Pool.submit([&Blocks, &Pages, Compress, i] { Blocks[i] = Compress(Pages[i].Data); });
+            }
+        }
+        Pool.wait();
+    }
+    for (size_t i = 0; i < Pages.size(); i++) {
+        if (!Pages[i].Data) {
+            Blocks[i] = ZeroBlock;
+        }
+    }
+    return Blocks;
+}
+
+// ED ED <count> <byte> for runs of 5 or more bytes and for any run of EDs,
+// the byte after a single ED is never the start of a run
+PageBlock compressZ80Page(const uint8_t *Data) {
+    std::string Out;
+    size_t i = 0;
+    while (i < PageSize) {
+        uint8_t B = Data[i];
+        size_t Run = 1;
+        while (i + Run < PageSize && Run < 255 && Data[i + Run] == B) {
+            Run++;
+        }
+        if (Run >= 5 || (B == 0xED && Run >= 2)) {
+            Out += "\xED\xED"s;
+            Out += (char) Run;
+            Out += (char) B;
+            i += Run;
+        } else {
+            Out += (char) B;
+            i++;
+            if (B == 0xED && i < PageSize) {
+                Out += (char) Data[i++];
+            }
+        }
+    }
+    if (Out.size() >= PageSize) {
+        return {false, std::string((const char *) Data, PageSize)};
+    }
+    return {true, Out};
+}
+
+PageBlock compressSZXPage(const uint8_t *Data) {
+#ifdef SJASMPLUS_HAVE_ZLIB
+    uLongf Size = compressBound(PageSize);
+    std::string Out(Size, '\0');
+    if (compress2((Bytef *) &Out[0], &Size, Data, PageSize, Z_DEFAULT_COMPRESSION) == Z_OK && Size < PageSize) {
+        Out.resize(Size);
+        return {true, Out};
+    }
+#endif
+    return {false, std::string((const char *) Data, PageSize)};
+}
+
+void putWord(std::string &Out, uint16_t W) {
+    Out += (char) (W & 0xff);
+    Out += (char) (W >> 8);
+}
+
+void putDWord(std::string &Out, uint32_t D) {
+    putWord(Out, (uint16_t) (D & 0xffff));
+    putWord(Out, (uint16_t) (D >> 16));
+}
+
+// Register pair from the SNA header
+void putSnaWord(std::string &Out, const Registers &Regs, int Offset) {
+    Out += (char) Regs.Sna[Offset];
+    Out += (char) Regs.Sna[Offset + 1];
+}
+
+uint8_t port7FFD(MemModel &M) {
+    return M.isPagedMemory() ? (uint8_t) (0x10 + M.getPageNumInSlot(3)) : 0;
+}
+
+bool writeSnapshot(MemModel &M, const fs::path &fname, const std::string &Data) {
+    fs::ofstream ofs(fname, std::ios_base::binary);
+    if (!ofs) {
+        Fatal("Error opening file"s, fname.string());
+    }
+    ofs.write(Data.data(), Data.size());
+    ofs.close();
+    if (ofs.fail()) {
+        Error("Error writing to "s + fname.string(), strerror(errno), CATCHALL);
+        return false;
+    }
+    if (M.isPagedMemory() && M.getName() != "ZXSPECTRUM128"s) {
+        Warning("Only 128kb will be written to snapshot"s, fname.string());
+    }
+    return true;
+}
+
+} // namespace
+
+bool saveZ80(MemModel &M, const fs::path &fname, uint16_t start) {
+    const Registers Regs = initRegisters(M, start, false);
+    const uint8_t *snbuf = Regs.Sna;
+
+    // Version 1 header with PC = 0 for version 2 and later
+    std::string Out;
+    Out += (char) snbuf[22]; // a
+    Out += (char) snbuf[21]; // f
+    putSnaWord(Out, Regs, 13); // bc
+    putSnaWord(Out, Regs, 9); // hl
+    putWord(Out, 0);
+    putWord(Out, Regs.SP);
+    Out += (char) snbuf[0]; // i
+    Out += (char) (snbuf[20] & 0x7f); // r
+    Out += (char) ((snbuf[20] >> 7) | (snbuf[26] << 1)); // r bit 7, border
+    putSnaWord(Out, Regs, 11); // de
+    putSnaWord(Out, Regs, 5); // bc'
+    putSnaWord(Out, Regs, 3); // de'
+    putSnaWord(Out, Regs, 1); // hl'
+    Out += (char) snbuf[8]; // a'
+    Out += (char) snbuf[7]; // f'
+    putSnaWord(Out, Regs, 15); // iy
+    putSnaWord(Out, Regs, 17); // ix
+    Out += (char) ((snbuf[19] >> 2) & 1); // iff1
+    Out += (char) ((snbuf[19] >> 2) & 1); // iff2
+    Out += (char) (snbuf[25] & 3); // im
+
+    // Version 3 additional header
+    std::string Ext(54, '\0');
+    Ext[0] = (char) (Regs.PC & 0xff);
+    Ext[1] = (char) (Regs.PC >> 8);
+    Ext[2] = (char) (M.isPagedMemory() ? 4 : 0); // hardware: 48K or 128K
+    Ext[3] = (char) port7FFD(M);
+    Ext[29] = Ext[30] = (char) 0xff; // ROM at 0000h-3FFFh
+    putWord(Out, (uint16_t) Ext.size());
+    Out += Ext;
+
+    const int Numbers48K[3] = {8, 4, 5};
+    const auto Pages = snapshotPages(M, Numbers48K, 3);
+    const auto Blocks = compressPages(Pages, compressZ80Page);
+    M.clearEphemerals();
+    for (size_t i = 0; i < Pages.size(); i++) {
+        putWord(Out, Blocks[i].Compressed ? (uint16_t) Blocks[i].Data.size() : (uint16_t) 0xffff);
+        Out += (char) Pages[i].Number;
+        Out += Blocks[i].Data;
+    }
+    return writeSnapshot(M, fname, Out);
+}
+
+bool saveSZX(MemModel &M, const fs::path &fname, uint16_t start) {
+    const Registers Regs = initRegisters(M, start, false);
+    const uint8_t *snbuf = Regs.Sna;
+
+    std::string Out{"ZXST"s};
+    Out += (char) 1; // version 1.4
+    Out += (char) 4;
+    Out += (char) (M.isPagedMemory() ? 2 : 1); // 128K or 48K
+    Out += (char) 0;
+
+    Out += "Z80R"s;
+    putDWord(Out, 37);
+    putSnaWord(Out, Regs, 21); // af
+    putSnaWord(Out, Regs, 13); // bc
+    putSnaWord(Out, Regs, 11); // de
+    putSnaWord(Out, Regs, 9); // hl
+    putSnaWord(Out, Regs, 7); // af'
+    putSnaWord(Out, Regs, 5); // bc'
+    putSnaWord(Out, Regs, 3); // de'
+    putSnaWord(Out, Regs, 1); // hl'
+    putSnaWord(Out, Regs, 17); // ix
+    putSnaWord(Out, Regs, 15); // iy
+    putWord(Out, Regs.SP);
+    putWord(Out, Regs.PC);
+    Out += (char) snbuf[0]; // i
+    Out += (char) snbuf[20]; // r
+    Out += (char) ((snbuf[19] >> 2) & 1); // iff1
+    Out += (char) ((snbuf[19] >> 2) & 1); // iff2
+    Out += (char) snbuf[25]; // im
+    putDWord(Out, 0); // cycles since the interrupt
+    Out += (char) 0; // hold interrupt request cycles
+    Out += (char) 0; // flags
+    putWord(Out, 0); // memptr
+
+    Out += "SPCR"s;
+    putDWord(Out, 8);
+    Out += (char) snbuf[26]; // border
+    Out += (char) port7FFD(M);
+    Out += (char) 0; // 1ffd
+    Out += (char) snbuf[26]; // last out to fe
+    putDWord(Out, 0);
+
+    const int Numbers48K[3] = {5, 2, 0};
+    const auto Pages = snapshotPages(M, Numbers48K, 0);
+    const auto Blocks = compressPages(Pages, compressSZXPage);
+    M.clearEphemerals();
+    for (size_t i = 0; i < Pages.size(); i++) {
+        Out += "RAMP"s;
+        putDWord(Out, (uint32_t) (3 + Blocks[i].Data.size()));
+        putWord(Out, Blocks[i].Compressed ? 1 : 0);
+        Out += (char) Pages[i].Number;
+        Out += Blocks[i].Data;
+    }
+    return writeSnapshot(M, fname, Out);
+}
+
 } // namespace zx
 
 //eof io_snapshots.cpp
@@ -37,6 +37,12 @@ namespace zx {
 
 bool saveSNA(MemModel &M, const fs::path &fname, uint16_t start);
 
+// Version 3 .z80 with RLE compressed pages
+bool saveZ80(MemModel &M, const fs::path &fname, uint16_t start);
+
+// .szx with zlib compressed pages if built with zlib
+bool saveSZX(MemModel &M, const fs::path &fname, uint16_t start);
+
 } // namespace zx
 
 #endif //SJASMPLUS_IO_SNAPSHOTS_H
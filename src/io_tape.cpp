@@ -27,8 +27,12 @@ misrepresented as being the original software.
 // io_tape.cpp
 
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 
 #include <string>
 using namespace std::string_literals;
@@ -38,25 +42,18 @@ using namespace std::string_literals;
 #include "memory.h"
 #include "codeemitter.h"
 #include "zxspectrum.h"
+#include "util.h"
 
 #include "io_tape.h"
 
+// FIXME: errors.cpp
+class Assembler;
+extern thread_local Assembler *Asm;
+
 #include "../resources/SaveTAP_ZX_Spectrum_48K.bin.h"
 #include "../resources/SaveTAP_ZX_Spectrum_128K.bin.h"
 #include "../resources/SaveTAP_ZX_Spectrum_256K.bin.h"
 
-unsigned char parity;
-unsigned char blocknum = 1;
-
-std::ostream &writebyte(std::ostream &stream, unsigned char c);
-
-std::ostream &writenumber(std::ostream &stream, unsigned int);
-
-std::ostream &writeword(std::ostream &stream, unsigned int);
-
-std::ostream &writecode(std::ostream &stream, const unsigned char *block, uint16_t length,
-                        unsigned short loadaddr, bool header);
-
 void remove_basic_sp(unsigned char *ram);
 
 void detect_vars_changes(MemModel &M);
@@ -69,47 +66,27 @@ namespace zx {
 
 bool saveTAP(MemModel &M, const fs::path &FileName, uint16_t Start) {
 
-    fs::ofstream ofs;
-    ofs.open(FileName, std::ios_base::binary);
-    if (ofs.fail()) {
-        Fatal("Error opening file"s, FileName.string());
-    }
-
     uint16_t datastart = 0x5E00;
     uint16_t exeat = 0x5E00;
 
-    ofs << (char) 19;                // header length
-    ofs << (char) 0;
-    ofs << (char) 0;
-    parity = 0;                        // initial checksum
-    writebyte(ofs, 0);            // block type "BASIC"
+    TapeWriter Tape;
 
+    // Header of the BASIC loader: "LINE 10", program length
     uint8_t filename[] = "Loader    ";
-    for (aint i = 0; i <= 9; i++)
-        writebyte(ofs, filename[i]);
-
-    writebyte(ofs, 0x1e + 2/*CLS*/);    // line length
-    writebyte(ofs, 0);
-    writebyte(ofs, 0x0a);               // "LINE 10"
-    writebyte(ofs, 0);
-    writebyte(ofs, 0x1e + 2/*CLS*/);    // line length
-    writebyte(ofs, 0);
-    writebyte(ofs, parity);             // checksum
-
-    writeword(ofs, 0x1e + 2/*CLS*/ + 2);// length of block
-    parity = 0;
-    writebyte(ofs, 0xff);
-    writebyte(ofs, 0);
-    writebyte(ofs, 0x0a);
-    writebyte(ofs, 0x1a + 2/*CLS*/);    // basic line length - 0x1a
-    writebyte(ofs, 0);
+    Tape.addHeader(0, filename, 0x1e + 2/*CLS*/, 0x0a, 0x1e + 2/*CLS*/);
+
+    Tape.beginBlock(0xff);
+    Tape.addByte(0);
+    Tape.addByte(0x0a);
+    Tape.addByte(0x1a + 2/*CLS*/);    // basic line length - 0x1a
+    Tape.addByte(0);
 
     // :CLEAR VAL "xxxxx"
-    writebyte(ofs, 0xfd);            // CLEAR
-    writebyte(ofs, 0xb0);            // VAL
-    writebyte(ofs, '\"');
-    writenumber(ofs, datastart - 1);
-    writebyte(ofs, '\"');
+    Tape.addByte(0xfd);            // CLEAR
+    Tape.addByte(0xb0);            // VAL
+    Tape.addByte('\"');
+    Tape.addNumber(datastart - 1);
+    Tape.addByte('\"');
 
     // :INK VAL "7"
     /*writebyte(':', fpout);
@@ -136,32 +113,32 @@ bool saveTAP(MemModel &M, const fs::path &FileName, uint16_t Start) {
     writebyte('\"', fpout);*/
 
     // :CLS
-    writebyte(ofs, ':');
-    writebyte(ofs, 0xfb);           // CLS
-
-    writebyte(ofs, ':');
-    writebyte(ofs, 0xef);           /* LOAD */
-    writebyte(ofs, '\"');
-    writebyte(ofs, '\"');
-    writebyte(ofs, 0xaf);           /* CODE */
-    writebyte(ofs, ':');
-    writebyte(ofs, 0xf9);           /* RANDOMIZE */
-    writebyte(ofs, 0xc0);           /* USR */
-    writebyte(ofs, 0xb0);           /* VAL */
-    writebyte(ofs, '\"');
-    writenumber(ofs, exeat);
-    writebyte(ofs, '\"');
-    writebyte(ofs, 0x0d);
-    writebyte(ofs, parity);
+    Tape.addByte(':');
+    Tape.addByte(0xfb);           // CLS
+
+    Tape.addByte(':');
+    Tape.addByte(0xef);           /* LOAD */
+    Tape.addByte('\"');
+    Tape.addByte('\"');
+    Tape.addByte(0xaf);           /* CODE */
+    Tape.addByte(':');
+    Tape.addByte(0xf9);           /* RANDOMIZE */
+    Tape.addByte(0xc0);           /* USR */
+    Tape.addByte(0xb0);           /* VAL */
+    Tape.addByte('\"');
+    Tape.addNumber(exeat);
+    Tape.addByte('\"');
+    Tape.addByte(0x0d);
+    Tape.endBlock();
 
     if (!M.isPagedMemory()) {
         // prepare code block
         uint16_t ram_length = 0xA200;
         uint16_t ram_start = 0x0000;
         auto *ram = new uint8_t[ram_length];
-        M.getBytes(ram, 0x4000 + 0x1E00, 0x2200);
-        M.getBytes(ram + 0x2200, 0x8000, 0x4000);
-        M.getBytes(ram + 0x6200, 0xC000, 0x4000);
+        M.readSpan(ram, 0x4000 + 0x1E00, 0x2200);
+        M.readSpan(ram + 0x2200, 0x8000, 0x4000);
+        M.readSpan(ram + 0x6200, 0xC000, 0x4000);
 
         detect_vars_changes(M);
 
@@ -180,18 +157,18 @@ bool saveTAP(MemModel &M, const fs::path &FileName, uint16_t Start) {
         loader[SaveTAP_ZX_Spectrum_48K_SZ - 3] = uint8_t((ram_start + 0x5E00) >> 8);
         loader[SaveTAP_ZX_Spectrum_48K_SZ - 2] = uint8_t(ram_length & 0x00FF);
         loader[SaveTAP_ZX_Spectrum_48K_SZ - 1] = uint8_t(ram_length >> 8);
-        writecode(ofs, loader, SaveTAP_ZX_Spectrum_48K_SZ, 0x5E00, true);
+        Tape.addCode(loader, SaveTAP_ZX_Spectrum_48K_SZ, 0x5E00, true);
 
         // write screen$
         if (loader[SaveTAP_ZX_Spectrum_48K_SZ - 7]) {
             const int sz = 6192;
             uint8_t buf[sz];
-            M.getBytes(buf, 0x4000, sz);
-            writecode(ofs, buf, sz, 16384, false);
+            M.readSpan(buf, 0x4000, sz);
+            Tape.addCode(buf, sz, 16384, false);
         }
 
         // write code block
-        writecode(ofs, ram + ram_start, ram_length, (uint16_t)0x5E00 + ram_start, false);
+        Tape.addCode(ram + ram_start, ram_length, (uint16_t)0x5E00 + ram_start, false);
 
         delete [] loader;
         delete[] ram;
@@ -243,7 +220,7 @@ bool saveTAP(MemModel &M, const fs::path &FileName, uint16_t Start) {
         // build pages table
         int count = 0;
         for (int i = 0; i < M.getNumMemPages(); i++) {
-            if (M.getPageNumInSlot(2) != i && M.getPageNumInSlot(1) != i) {
+            if (M.getPageNumInSlot(2) != i && M.getPageNumInSlot(1) != i && M.isPageTouched(i)) {
                 uint16_t length = 0x4000;
                 length = remove_unused_space(M.getPtrToPage(i), length);
                 if (length > 0) {
@@ -269,97 +246,167 @@ bool saveTAP(MemModel &M, const fs::path &FileName, uint16_t Start) {
         loader[loader_defsize - 9] = uint8_t(isScreenOverwritten(M));
 
         // write loader
-        writecode(ofs, loader, loader_len, 0x5E00, true);
+        Tape.addCode(loader, loader_len, 0x5E00, true);
 
         // write screen$
         if (loader[loader_defsize - 9]) {
-            writecode(ofs, M.getPtrToPageInSlot(1), 6912, 0x4000, false);
+            Tape.addCode(M.getPtrToPageInSlot(1), 6912, 0x4000, false);
         }
 
         // write code blocks
         for (aint i = 0; i < count; i++) {
-            writecode(ofs, pages_ram[i] + pages_start[i], pages_len[i], (uint16_t)0xC000 + pages_start[i], false);
+            Tape.addCode(pages_ram[i] + pages_start[i], pages_len[i], (uint16_t)0xC000 + pages_start[i], false);
         }
 
         // write main code block
-        writecode(ofs, ram + ram_start, ram_length, (uint16_t)0x5E00 + ram_start, false);
+        Tape.addCode(ram + ram_start, ram_length, (uint16_t)0x5E00 + ram_start, false);
 
         delete[] loader;
         delete[] ram;
     }
 
+    fs::ofstream ofs;
+    ofs.open(FileName, std::ios_base::binary);
+    if (ofs.fail()) {
+        Fatal("Error opening file"s, FileName.string());
+    }
+    Tape.write(ofs);
     ofs.close();
-    return true;
+    return !ofs.fail();
 }
 
 } // namespace zx
 
-std::ostream &writenumber(std::ostream &stream, unsigned int i) {
-    int c;
-    c = i / 10000;
-    i -= c * 10000;
-    writebyte(stream, c + 48);
-    c = i / 1000;
-    i -= c * 1000;
-    writebyte(stream, c + 48);
-    c = i / 100;
-    i -= c * 100;
-    writebyte(stream, c + 48);
-    c = i / 10;
-    writebyte(stream, c + 48);
-    i %= 10;
-    writebyte(stream, i + 48);
-    return stream;
+namespace zx {
+
+namespace {
+
+// XOR of all bytes, 8 bytes at a time
+uint8_t xorBytes(const uint8_t *Bytes, size_t Size) {
+    uint64_t Acc = 0;
+    size_t i = 0;
+    for (; i + 8 <= Size; i += 8) {
+        uint64_t W;
+        std::memcpy(&W, Bytes + i, 8);
+        Acc ^= W;
+    }
+    Acc ^= Acc >> 32;
+    Acc ^= Acc >> 16;
+    Acc ^= Acc >> 8;
+    auto Result = (uint8_t) Acc;
+    for (; i < Size; i++) {
+        Result ^= Bytes[i];
+    }
+    return Result;
 }
 
-std::ostream &writeword(std::ostream &stream, unsigned int i) {
-    writebyte(stream, i % 256);
-    writebyte(stream, i / 256);
-    return stream;
+// Tapes of SAVETAPBLOCK by assembler and fileKey(). Deferred saves to
+// one tape run one at a time, so only the map is locked.
+std::map<std::pair<const Assembler *, fs::path>, std::unique_ptr<fs::ofstream>> OpenTapes;
+std::mutex OpenTapesMutex;
+
+fs::ofstream &openTape(const fs::path &FileName, std::ios_base::openmode Mode) {
+    const auto Key = std::make_pair((const Assembler *) Asm, fileKey(FileName));
+    std::lock_guard<std::mutex> Lock(OpenTapesMutex);
+    auto &OFS = OpenTapes[Key];
+    if (!OFS || (Mode & std::ios_base::trunc)) {
+        OFS.reset(new fs::ofstream(Key.second, std::ios_base::binary | std::ios_base::out | Mode));
+        if (!*OFS) {
+            OpenTapes.erase(Key);
+            Fatal("Error opening file"s, FileName.string());
+        }
+    }
+    return *OFS;
 }
 
-std::ostream &writebyte(std::ostream &stream, unsigned char c) {
-    stream << c;
-    parity ^= c;
-    return stream;
+} // namespace
+
+void emptyTAP(const fs::path &FileName) {
+    openTape(FileName, std::ios_base::trunc);
 }
 
-std::ostream &writecode(std::ostream &stream, const unsigned char *block, uint16_t length,
-                        unsigned short loadaddr, bool header) {
-    if (header) {
-        /* Write out the code header file */
-        stream << (char) 19;        /* Header len */
-        stream << (char) 0;         /* MSB of len */
-        stream << (char) 0;         /* Header is 0 */
-        parity = 0;
-        writebyte(stream, 3);    /* Filetype (Code) */
-
-        /*char *blockname = new char[32];
-        SPRINTF1(blockname, 32, "Code %02d   ", blocknum++);
-        for	(aint i=0;i<=9;i++)
-            writebyte(blockname[i], fp);
-        delete[] blockname;*/
-        uint8_t filename[] = "Loader    ";
-        for (int i = 0; i <= 9; i++)
-            writebyte(stream, filename[i]);
-
-        writeword(stream, length);
-        writeword(stream, loadaddr); /* load address: 49152 by default */
-        writeword(stream, 0);    /* offset */
-        writebyte(stream, parity);
+bool addTAPBlock(MemModel &M, const fs::path &FileName, const std::string &Name,
+                 uint16_t Start, uint16_t Length, int Page, uint16_t LoadAddr) {
+    // A tape not started with EMPTYTAP in this build is appended to
+    auto &OFS = openTape(FileName, std::ios_base::app);
+    std::vector<uint8_t> Block(Length);
+    if (Page >= 0) {
+        std::memcpy(Block.data(), M.getPtrToPage(Page) + Start, Length);
+    } else {
+        M.readSpan(Block.data(), Start, Length);
+    }
+    TapeWriter Tape;
+    if (!Name.empty()) {
+        uint8_t TapeName[10];
+        std::memset(TapeName, ' ', sizeof(TapeName));
+        std::memcpy(TapeName, Name.data(), std::min(Name.size(), sizeof(TapeName)));
+        Tape.addHeader(3, TapeName, Length, LoadAddr, 0x8000);
     }
+    Tape.beginBlock(0xff);
+    Tape.addBytes(Block.data(), Length);
+    Tape.endBlock();
+    Tape.write(OFS);
+    return !OFS.fail();
+}
 
-    /* Now onto the data bit */
-    writeword(stream, length + 2);    /* Length of next block */
-    parity = 0;
-    writebyte(stream, 255);    /* Data... */
-    for (aint i = 0; i < length; i++) {
-        writebyte(stream, block[i]);
+void flushTAP() {
+    std::lock_guard<std::mutex> Lock(OpenTapesMutex);
+    auto T = OpenTapes.lower_bound({Asm, fs::path{}});
+    while (T != OpenTapes.end() && T->first.first == Asm) {
+        T->second->close();
+        if (T->second->fail()) {
+            Error("Write error (disk full?)"s, T->first.second.string(), ALL);
+        }
+        T = OpenTapes.erase(T);
     }
-    writebyte(stream, parity);
-    return stream;
 }
 
+void TapeWriter::beginBlock(uint8_t Flag) {
+    BlockStart = Data.size();
+    addWord(0);
+    addByte(Flag);
+}
+
+void TapeWriter::addNumber(unsigned int Number) {
+    char Digits[5];
+    for (int i = 4; i >= 0; i--) {
+        Digits[i] = (char) ('0' + Number % 10);
+        Number /= 10;
+    }
+    addBytes((const uint8_t *) Digits, sizeof(Digits));
+}
+
+void TapeWriter::endBlock() {
+    // Flag and data
+    size_t Size = Data.size() - BlockStart - 2;
+    addByte(xorBytes((const uint8_t *) Data.data() + BlockStart + 2, Size));
+    Data[BlockStart] = (char) ((Size + 1) & 0xff);
+    Data[BlockStart + 1] = (char) ((Size + 1) >> 8);
+    BlockStart = std::string::npos;
+}
+
+void TapeWriter::addHeader(uint8_t Type, const uint8_t *Name, uint16_t Length, uint16_t Param1, uint16_t Param2) {
+    beginBlock(0);
+    addByte(Type);
+    addBytes(Name, 10);
+    addWord(Length);
+    addWord(Param1);
+    addWord(Param2);
+    endBlock();
+}
+
+void TapeWriter::addCode(const uint8_t *Block, uint16_t Length, uint16_t LoadAddr, bool Header) {
+    if (Header) {
+        const uint8_t Name[] = "Loader    ";
+        addHeader(3, Name, Length, LoadAddr, 0);
+    }
+    beginBlock(0xff);
+    addBytes(Block, Length);
+    endBlock();
+}
+
+} // namespace zx
+
 void detect_vars_changes(MemModel &M) {
     if (zx::isBasicVarAreaOverwritten(M)) {
         // FIXME:
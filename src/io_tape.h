@@ -30,12 +30,73 @@ misrepresented as being the original software.
 #define SJASMPLUS_IO_TAPE_H
 
 #include <cstdint>
+#include <ostream>
+#include <string>
 #include "fs.h"
 
+class MemModel;
+
 namespace zx {
 
+// Builds a tape image in memory. Each block is its 16-bit length, a flag byte
+// (0 for headers, 0xff for data), the data and the XOR of the flag and data.
+// There is no global state, so several tapes can be built at the same time.
+class TapeWriter {
+private:
+    std::string Data;
+    size_t BlockStart = std::string::npos;
+
+public:
+    void beginBlock(uint8_t Flag);
+
+    void addByte(uint8_t Byte) {
+        Data += (char) Byte;
+    }
+
+    void addWord(uint16_t Word) {
+        addByte((uint8_t) (Word & 0xff));
+        addByte((uint8_t) (Word >> 8));
+    }
+
+    void addBytes(const uint8_t *Bytes, size_t Size) {
+        Data.append((const char *) Bytes, Size);
+    }
+
+    // Five decimal digits for BASIC
+    void addNumber(unsigned int Number);
+
+    // Fill in the length and append the checksum
+    void endBlock();
+
+    // Header block: Type (0 = program, 3 = code), 10 characters of Name
+    void addHeader(uint8_t Type, const uint8_t *Name, uint16_t Length, uint16_t Param1, uint16_t Param2);
+
+    // Data block, preceded by a code header named "Loader" if Header is set
+    void addCode(const uint8_t *Block, uint16_t Length, uint16_t LoadAddr, bool Header);
+
+    const std::string &data() const { return Data; }
+
+    void write(std::ostream &OS) const {
+        OS.write(Data.data(), Data.size());
+    }
+};
+
 bool saveTAP(MemModel &M, const fs::path &FileName, uint16_t Start);
 
+// Tapes of EMPTYTAP and SAVETAPBLOCK stay open and get one block at a time
+// appended, flushTAP() closes them
+
+// Start an empty tape
+void emptyTAP(const fs::path &FileName);
+
+// Append Length bytes from Start, or from offset Start in Page if it is not
+// negative. A code header with Name and load address LoadAddr comes first
+// unless Name is empty.
+bool addTAPBlock(MemModel &M, const fs::path &FileName, const std::string &Name,
+                 uint16_t Start, uint16_t Length, int Page, uint16_t LoadAddr);
+
+void flushTAP();
+
 } // namespace zx
 
 #endif // SJASMPLUS_IO_TAPE_H
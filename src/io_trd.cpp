@@ -27,8 +27,17 @@
 // io_trd.cpp
 
 #include "sjio.h"
+#include "asm.h"
+#include "global.h"
+#include "util.h"
+#include <map>
+#include <memory>
+#include <mutex>
 #include <numeric>
 
+// FIXME: errors.cpp
+extern thread_local Assembler *Asm;
+
 namespace {
 
     //TODO: extract
@@ -205,6 +214,11 @@ namespace {
         Catalogue *Catalog;
         ServiceSector *Service;
     public:
+        // The directive which changed the image last, TRD_Flush() reports
+        // its errors at that line
+        fs::path SrcFileName;
+        aint Line = 0;
+
         TRDImage()
                 : Content(TOTAL_SECTORS * SECTOR_SIZE),
                   Catalog(static_cast<Catalogue *>(GetSector(CATALOG_SECTOR_NUMBER))),
@@ -242,6 +256,15 @@ namespace {
             }
         }
 
+        // Catalogue and service sector, to undo a failed update
+        std::vector<char> SaveCatalogue() const {
+            return {Content.begin(), Content.begin() + (SERVICE_SECTOR_NUMBER + 1) * SECTOR_SIZE};
+        }
+
+        void RestoreCatalogue(const std::vector<char> &saved) {
+            std::copy(saved.begin(), saved.end(), Content.begin());
+        }
+
         void *AddFile(const HobetaFilename &name, unsigned start, unsigned size) {
             //assume that catalogue is fixed
             if (Service->TotalFiles == Catalogue::LIMIT) {
@@ -312,6 +335,27 @@ namespace {
         return name.GetType() == "B";
     }
 
+    // Images changed by EMPTYTRD and SAVETRD, each is written once by
+    // TRD_Flush() instead of being reloaded and rewritten for every file.
+    // Deferred saves to one image run one at a time, so only the map is locked.
+    // The images are kept by assembler, for assemblies running side by side,
+    // and by fileKey(), for every spelling of the image's name.
+    std::map<std::pair<const Assembler *, fs::path>, std::unique_ptr<TRDImage>> OpenImages;
+    std::mutex OpenImagesMutex;
+
+    TRDImage *FindOpenImage(const fs::path &FileName) {
+        std::lock_guard<std::mutex> lock(OpenImagesMutex);
+        auto it = OpenImages.find({Asm, FileName});
+        return it == OpenImages.end() ? nullptr : it->second.get();
+    }
+
+    TRDImage *AddOpenImage(const fs::path &FileName, std::unique_ptr<TRDImage> image) {
+        std::lock_guard<std::mutex> lock(OpenImagesMutex);
+        auto &slot = OpenImages[{Asm, FileName}];
+        slot = std::move(image);
+        return slot.get();
+    }
+
     static_assert(sizeof(DiskLocation) == 2, "sizeof(DiskLocation) != 2");
     static_assert(sizeof(CatEntry) == 16, "sizeof(CatEntry) != 16");
     static_assert(sizeof(Catalogue) == 128 * 16, "sizeof(Catalogue) != 128 * 16");
@@ -319,25 +363,20 @@ namespace {
     static_assert(sizeof(HobetaHeader) == 17, "sizeof(HobetaHeader) != 17");
 }
 
-int TRD_SaveEmpty(const fs::path &FileName) {
-    fs::ofstream OFS(FileName, std::ios::binary);
-
-    if (!OFS) {
-        Error("Error opening file"s, FileName.string(), CATCHALL);
-        return 0;
+namespace {
+    void setDirective(TRDImage &Image) {
+        Image.SrcFileName = getCurrentSrcFileNameForMsg();
+        Image.Line = CurrentLocalLine;
     }
+}
 
-    TRDImage Image;
-    Image.Save(OFS);
-    if (!OFS) {
-        Error("Write error (disk full?)"s, FileName.string(), CATCHALL);
-        return 0;
-    } else {
-        return 1;
-    }
+int TRD_SaveEmpty(const fs::path &FileName) {
+    TRDImage *Image = AddOpenImage(fileKey(FileName), std::unique_ptr<TRDImage>(new TRDImage));
+    setDirective(*Image);
+    return 1;
 }
 
-int TRD_AddFile(const fs::path &FileName, const HobetaFilename &HobetaFileName, int Start, int Length,
+int TRD_AddFile(MemModel &M, const fs::path &FileName, const HobetaFilename &HobetaFileName, int Start, int Length,
                 int Autostart) { //autostart added by boo_boo 19_0ct_2008
     // for Lua
 /*
@@ -361,40 +400,83 @@ int TRD_AddFile(const fs::path &FileName, const HobetaFilename &HobetaFileName,
         Length = 0x10000 - Start;
     }
 
-    fs::fstream OFS(FileName, std::ios::binary | std::ios::in | std::ios::out);
-
-    if (!OFS) {
-        Fatal("Error opening file"s, FileName.string());
-    }
-
-    TRDImage Image;
-    if (!Image.Load(OFS)) {
-        Error("Failed to read TRD image from (I/O error or invalid format)"s, FileName.string(), CATCHALL);
-        return 0;
+    const fs::path AbsFileName = fileKey(FileName);
+    TRDImage *Image = FindOpenImage(AbsFileName);
+    if (!Image) {
+        fs::ifstream IFS(AbsFileName, std::ios::binary);
+        if (!IFS) {
+            Fatal("Error opening file"s, FileName.string());
+        }
+        std::unique_ptr<TRDImage> Loaded(new TRDImage);
+        if (!Loaded->Load(IFS)) {
+            Error("Failed to read TRD image from (I/O error or invalid format)"s, FileName.string(), CATCHALL);
+            return 0;
+        }
+        Image = AddOpenImage(AbsFileName, std::move(Loaded));
     }
-    Image.DeleteFile(HobetaFileName);
+    setDirective(*Image);
+    const std::vector<char> Catalogue = Image->SaveCatalogue();
+    Image->DeleteFile(HobetaFileName);
 
     unsigned char AutostartData[] =
             {0x80, 0xaa, (uint8_t) (Autostart & 0xff), (uint8_t) (Autostart >> 8)};
 
     unsigned RealLength = Autostart > 0 ? Length + sizeof(AutostartData) : Length;
-    if (void *data = Image.AddFile(HobetaFileName, IsBasic(HobetaFileName) ? Length : Start, RealLength)) {
-        void *end = SaveRAM(data, Start, Length);
+    if (void *data = Image->AddFile(HobetaFileName, IsBasic(HobetaFileName) ? Length : Start, RealLength)) {
+        void *end = SaveRAM(M, data, Start, Length);
         if (Autostart > 0) {
             std::memcpy(end, AutostartData, sizeof(AutostartData));
         }
     } else {
+        // Keep the file of the same name as the image on disk would have
+        Image->RestoreCatalogue(Catalogue);
         Error("No space in TRD image"s, FileName.string(), CATCHALL);
         return 0;
     }
-    if (OFS.seekg(0) && Image.Save(OFS)) {
-        return 1;
+    return 1;
+}
+
+void TRD_Flush() {
+    std::map<fs::path, std::unique_ptr<TRDImage>> Images;
+    {
+        std::lock_guard<std::mutex> lock(OpenImagesMutex);
+        for (auto it = OpenImages.lower_bound({Asm, fs::path{}}); it != OpenImages.end() && it->first.first == Asm;) {
+            Images.emplace(it->first.second, std::move(it->second));
+            it = OpenImages.erase(it);
+        }
     }
-    Error("Failed to save TRD image"s, FileName.string(), CATCHALL);
-    return 0;
+    const fs::path SrcFileName = getCurrentSrcFileNameForMsg();
+    const aint Line = CurrentLocalLine;
+    for (auto &I : Images) {
+        setCurrentSrcFileNameForMsg(I.second->SrcFileName);
+        CurrentLocalLine = I.second->Line;
+        // Write a temporary file and rename it, so the image is replaced as a whole
+        fs::path TmpFileName = I.first;
+        TmpFileName += ".tmp"s;
+        fs::ofstream OFS(TmpFileName, std::ios::binary);
+        if (!OFS) {
+            Error("Error opening file"s, TmpFileName.string(), ALL);
+            continue;
+        }
+        I.second->Save(OFS);
+        OFS.close();
+        if (!OFS) {
+            Error("Write error (disk full?)"s, TmpFileName.string(), ALL);
+            fs::remove(TmpFileName);
+            continue;
+        }
+        boost::system::error_code EC;
+        fs::rename(TmpFileName, I.first, EC);
+        if (EC) {
+            Error("Failed to save TRD image"s, I.first.string() + ": "s + EC.message(), ALL);
+            fs::remove(TmpFileName, EC);
+        }
+    }
+    setCurrentSrcFileNameForMsg(SrcFileName);
+    CurrentLocalLine = Line;
 }
 
-int SaveHobeta(const fs::path &FileName, const HobetaFilename &HobetaFileName, int Start, int Length) {
+int SaveHobeta(MemModel &M, const fs::path &FileName, const HobetaFilename &HobetaFileName, int Start, int Length) {
 
     fs::ofstream OFS(FileName, std::ios::binary);
 
@@ -421,7 +503,7 @@ int SaveHobeta(const fs::path &FileName, const HobetaFilename &HobetaFileName, i
     SaveLEWord(hdr.FullSize, SECTOR_SIZE * entry.SectorsCount);
     SaveLEWord(hdr.CRC, 105 + 257 * std::accumulate(hdr.Filename, hdr.Filename + 15, 0u));
 
-    SaveRAM(&buffer[sizeof(HobetaHeader)], Start, Length);
+    SaveRAM(M, &buffer[sizeof(HobetaHeader)], Start, Length);
 
     if (OFS.write(&buffer.front(), buffer.size())) {
         return 1;
@@ -430,4 +512,15 @@ int SaveHobeta(const fs::path &FileName, const HobetaFilename &HobetaFileName, i
     return 0;
 }
 
+int TRD_SaveEmpty(char *FileName) {
+    Asm->Saves.waitAll();
+    return TRD_SaveEmpty(fs::path(FileName));
+}
+
+int TRD_AddFile(char *FileName, char *HobetaFileName, int Start, int Length, int Autostart) {
+    Asm->Saves.waitAll();
+    return TRD_AddFile(Asm->Em.getMemModel(), fs::path(FileName), HobetaFilename(HobetaFileName),
+                       Start, Length, Autostart);
+}
+
 //eof io_trd.cpp
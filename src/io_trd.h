@@ -34,6 +34,8 @@
 #include <string>
 #include "fs.h"
 
+class MemModel;
+
 class HobetaFilename {
 private:
     std::string Content;
@@ -80,18 +82,17 @@ public:
 
 int TRD_SaveEmpty(const fs::path &FileName);
 
-int TRD_AddFile(const fs::path &FileName, const HobetaFilename &HobetaFileName,
+int TRD_AddFile(MemModel &M, const fs::path &FileName, const HobetaFilename &HobetaFileName,
                 int Start, int Length, int Autostart);
 
-int SaveHobeta(const fs::path &FileName, const HobetaFilename &HobetaFileName, int Start, int Length);
+// EMPTYTRD and TRD_AddFile() change images in memory, TRD_Flush() writes them
+void TRD_Flush();
+
+int SaveHobeta(MemModel &M, const fs::path &FileName, const HobetaFilename &HobetaFileName, int Start, int Length);
 
-//lua adapters
-inline int TRD_SaveEmpty(char *FileName) {
-    return TRD_SaveEmpty(fs::path(FileName));
-}
+//lua adapters, run after the pending SAVE* directives and use the current memory
+int TRD_SaveEmpty(char *FileName);
 
-inline int TRD_AddFile(char *FileName, char *HobetaFileName, int Start, int Length, int Autostart) {
-    return TRD_AddFile(fs::path(FileName), HobetaFilename(HobetaFileName), Start, Length, Autostart);
-}
+int TRD_AddFile(char *FileName, char *HobetaFileName, int Start, int Length, int Autostart);
 
 #endif // SJASMPLUS_IO_TRD_H
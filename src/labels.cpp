@@ -26,11 +26,12 @@
 
 */
 
-#include <sstream>
 #include <algorithm>
+#include <vector>
 #include "defines.h"
 #include "reader.h"
 #include "util.h"
+#include "lebytes.h"
 #include "global.h"
 #include "support.h"
 #include "parser/macro.h"
@@ -178,28 +179,35 @@ void CLabels::removeAll() {
 }
 
 std::string CLabels::dump() const {
-    std::stringstream Str;
-    Str << std::endl
-        << "Value    Label" << std::endl
-        << "------ - -----------------------------------------------------------" << std::endl;
+    std::string Str;
+    Str.reserve(80 + _LabelContainer.size() * 32);
+    Str += "\nValue    Label\n"
+           "------ - -----------------------------------------------------------\n";
 
     // List labels in order of insertion
     for (const auto &it : _LabelContainer) {
         if (it.page != -1) {
-            Str << "0x" << toHexAlt(it.value)
-                << (it.used > 0 ? "   " : " X ") << it.name
-                << std::endl;
+            Str += "0x";
+            appendHexAlt(Str, it.value);
+            Str += (it.used > 0 ? "   " : " X ");
+            Str += it.name;
+            Str += '\n';
         }
     }
 
-    return Str.str();
+    return Str;
 }
 
-void CLabels::dumpForUnreal(const fs::path &FileName) const {
+// The dumps below are formatted into one buffer and written at once.
+// They may run concurrently and return errors instead of reporting them.
+
+optional<std::string> CLabels::dumpForUnreal(const fs::path &FileName) const {
     fs::ofstream OFS(FileName);
     if (!OFS.is_open()) {
-        Fatal("Error opening file"s, FileName.string());
+        return "Error opening file: "s + FileName.string();
     }
+    std::string Str;
+    Str.reserve(_LabelContainer.size() * 32);
     for (const auto &it : _LabelContainer) {
         if (it.page == -1) {
             continue;
@@ -218,24 +226,106 @@ void CLabels::dumpForUnreal(const fs::path &FileName) const {
             lvalue -= 0xc000;
         }
         if (page != -1) {
-            OFS << '0' << char('0' + page);
+            Str += '0';
+            Str += char('0' + page);
         }
-        OFS << ':';
-        OFS << toHexAlt(lvalue);
-        OFS << ' ' << it.name << std::endl;
-    }
+        Str += ':';
+        appendHexAlt(Str, lvalue);
+        Str += ' ';
+        Str += it.name;
+        Str += '\n';
+    }
+    OFS.write(Str.data(), Str.size());
+    return boost::none;
 }
 
-void CLabels::dumpSymbols(const fs::path &FileName) const {
+optional<std::string> CLabels::dumpSymbols(const fs::path &FileName) const {
     fs::ofstream OFS(FileName);
     if (!OFS) {
-        Fatal("Error opening file"s, FileName.string());
+        return "Error opening file: "s + FileName.string();
     }
+    std::string Str;
+    Str.reserve(_LabelContainer.size() * 40);
     for (const auto &it : _LabelContainer) {
         if (isalpha(it.name[0])) {
-            OFS << it.name << ": equ 0x" << toHex32(it.value) << std::endl;
+            Str += it.name;
+            Str += ": equ 0x";
+            appendHex32(Str, it.value);
+            Str += '\n';
+        }
+    }
+    OFS.write(Str.data(), Str.size());
+    return boost::none;
+}
+
+// Binary symbol table (--sym-bin), all integers are little-endian:
+//
+//   Header     magic "SJSYMBIN", uint32 version, uint32 number of symbols,
+//              uint32 size of the names, uint64 offsets of the sections below
+//   Symbols    in definition order: uint32 name offset, uint32 name length,
+//              int32 value, uint8 flags (1 = used, 2 = DEFL), 3 bytes zero
+//   ByAddress  uint32 symbol numbers sorted by value, then by name
+//   ByName     uint32 symbol numbers sorted by name (bytewise)
+//   Names      all names without terminators
+//
+// Both sorted tables allow binary search, undefined labels are not included.
+optional<std::string> CLabels::dumpBinary(const fs::path &FileName) const {
+    fs::ofstream OFS(FileName, std::ios::binary);
+    if (!OFS) {
+        return "Error opening file: "s + FileName.string();
+    }
+    std::vector<const LabelData *> Symbols;
+    for (const auto &it : _LabelContainer) {
+        if (it.page != -1) {
+            Symbols.push_back(&it);
         }
     }
+    auto NumSymbols = (uint32_t) Symbols.size();
+
+    std::string Table, Names;
+    for (const auto *L : Symbols) {
+        put32(Table, (uint32_t) Names.size());
+        put32(Table, (uint32_t) L->name.size());
+        put32(Table, (uint32_t) L->value);
+        Table += (char) ((L->used > 0 ? 1 : 0) | (L->IsDEFL ? 2 : 0));
+        Table.append(3, '\0');
+        Names += L->name;
+    }
+
+    std::vector<uint32_t> Order(NumSymbols);
+    for (uint32_t i = 0; i < NumSymbols; i++) {
+        Order[i] = i;
+    }
+    std::sort(Order.begin(), Order.end(), [&Symbols](uint32_t A, uint32_t B) {
+        if (Symbols[A]->value != Symbols[B]->value)
+            return Symbols[A]->value < Symbols[B]->value;
+        return Symbols[A]->name < Symbols[B]->name;
+    });
+    std::string ByAddress;
+    for (auto i : Order) {
+        put32(ByAddress, i);
+    }
+    std::sort(Order.begin(), Order.end(), [&Symbols](uint32_t A, uint32_t B) {
+        return Symbols[A]->name < Symbols[B]->name;
+    });
+    std::string ByName;
+    for (auto i : Order) {
+        put32(ByName, i);
+    }
+
+    const uint64_t HeaderSize = 8 + 4 * 3 + 8 * 4;
+    std::string Header{"SJSYMBIN"};
+    put32(Header, 1);
+    put32(Header, NumSymbols);
+    put32(Header, (uint32_t) Names.size());
+    put64(Header, HeaderSize);
+    put64(Header, HeaderSize + Table.size());
+    put64(Header, HeaderSize + Table.size() + ByAddress.size());
+    put64(Header, HeaderSize + Table.size() + ByAddress.size() + ByName.size());
+    for (const auto *Part : {&Header, &Table, &ByAddress, &ByName, &Names}) {
+        OFS.write(Part->data(), Part->size());
+    }
+    return boost::none;
 }
 
 void CLabels::init() {
@@ -116,9 +116,12 @@ public:
 
     std::string dump() const;
 
-    void dumpForUnreal(const fs::path &FileName) const;
+    optional<std::string> dumpForUnreal(const fs::path &FileName) const;
 
-    void dumpSymbols(const fs::path &FileName) const;
+    optional<std::string> dumpSymbols(const fs::path &FileName) const;
+
+    // Symbols sorted by address and by name for lookups from tools
+    optional<std::string> dumpBinary(const fs::path &FileName) const;
 
     optional<std::string> validateLabel(const std::string &Name);
 
@@ -0,0 +1,50 @@
+#ifndef SJASMPLUS_LEBYTES_H
+#define SJASMPLUS_LEBYTES_H
+
+#include <cstdint>
+#include <string>
+
+// Little-endian integers and varints in binary output files
+
+inline void put16(std::string &Out, uint16_t V) {
+    Out += (char) (V & 0xff);
+    Out += (char) (V >> 8);
+}
+
+inline void put32(std::string &Out, uint32_t V) {
+    put16(Out, (uint16_t) (V & 0xffff));
+    put16(Out, (uint16_t) (V >> 16));
+}
+
+inline void put64(std::string &Out, uint64_t V) {
+    put32(Out, (uint32_t) (V & 0xffffffff));
+    put32(Out, (uint32_t) (V >> 32));
+}
+
+inline uint16_t get16(const char *P) {
+    return (uint16_t) ((uint8_t) P[0] | (uint8_t) P[1] << 8);
+}
+
+inline uint32_t get32(const char *P) {
+    return get16(P) | (uint32_t) get16(P + 2) << 16;
+}
+
+inline uint64_t get64(const char *P) {
+    return get32(P) | (uint64_t) get32(P + 4) << 32;
+}
+
+// 7 bits per byte, least significant first, high bit set on all but the last
+inline void putVarint(std::string &Out, uint64_t V) {
+    while (V >= 0x80) {
+        Out += (char) ((V & 0x7f) | 0x80);
+        V >>= 7;
+    }
+    Out += (char) V;
+}
+
+// Small negative and positive numbers get short varints
+inline uint64_t zigzag(int64_t V) {
+    return ((uint64_t) V << 1) ^ (uint64_t) (V >> 63);
+}
+
+#endif //SJASMPLUS_LEBYTES_H
@@ -1,92 +1,160 @@
 #include <iostream>
 #include <string>
+#include <algorithm>
+#include <cstring>
 #include "global.h"
 #include "options.h"
 #include "util.h"
 #include "asm.h"
+#include "errors.h"
 #include "listing.h"
 
-void ListingWriter::listBytes4() {
-    int i = 0;
-/*
-    while (nEB--) {
-        PrintHEX8(p, EB[i++]);
-        *(p++) = ' ';
-    }
-*/
-    std::for_each(ByteBuffer.begin(), ByteBuffer.end(), [&i,this](const uint8_t &Byte) {
-        OFS << toHex8(Byte) << ' ';
-        i++;
-    });
-    ByteBuffer.clear();
+ListingWriter::~ListingWriter() {
+    flush();
+}
+
+void ListingWriter::startWriter() {
+    Writer = std::thread(&ListingWriter::writerLoop, this);
+}
 
-    assert(i <= 4);
-    i = 4 - i;
-    while (i--) {
-        OFS << "   ";
-    }
-}
-
-void ListingWriter::listBytes5() {
-/*
-    for (int i = 0; i != 5; ++i) {
-        PrintHEX8(p, EB[i]);
-    }
-*/
-    auto beg = ByteBuffer.begin();
-    std::for_each(beg, beg + 5, [this](const uint8_t Byte) {
-        OFS << toHex8(Byte);
-    });
-
-    OFS << "  ";
-}
-
-std::string ListingWriter::printCurrentLocalLine() {
-    aint v = CurrentLocalLine;
-    std::string S;
-    switch (NumDigitsInLineNumber) {
-        default:
-            S += (unsigned char) ('0' + v / 1000000);
-            v %= 1000000;
-        case 6:
-            S += (unsigned char) ('0' + v / 100000);
-            v %= 100000;
-        case 5:
-            S += (unsigned char) ('0' + v / 10000);
-            v %= 10000;
-        case 4:
-            S += (unsigned char) ('0' + v / 1000);
-            v %= 1000;
-        case 3:
-            S += (unsigned char) ('0' + v / 100);
-            v %= 100;
-        case 2:
-            S += (unsigned char) ('0' + v / 10);
-            v %= 10;
-        case 1:
-            S += (unsigned char) ('0' + v);
-    }
-    S += (Asm.includeLevel() > 0 ? '+' : ' ');
-    S += (Asm.includeLevel() > 1 ? '+' : ' ');
-    S += (Asm.includeLevel() > 2 ? '+' : ' ');
-    return S;
-}
-
-void ListingWriter::listBytesLong(int pad, const std::string &Prefix) {
-    auto it = ByteBuffer.begin();
-    auto end = ByteBuffer.end();
-    while (it < end) {
-        OFS << Prefix << toHex16(pad) << ' ';
-        int t = 0;
-        while (it < end && t < 32) {
-            OFS << toHex8(*it);
-            ++it;
-            ++t;
+void ListingWriter::addRecord(ListingLine::Kind K, int Address, const char *Text, size_t TextSize) {
+    if (Current == nullptr) {
+        if (!Writer.joinable()) {
+            startWriter();
+        }
+        if (!FreeChunks.pop(Current)) {
+            Current = new ListingChunk;
+            Current->Records.reserve(ChunkRecords);
+            Current->Data.reserve(ChunkData + 0x1000);
         }
-        OFS << endl;
-        pad += 32;
     }
-    ByteBuffer.clear();
+    ListingRecord R;
+    R.K = K;
+    R.InMacro = InMacro;
+    R.IncludeLevel = (uint8_t) std::min(Asm.includeLevel(), 3);
+    R.NumDigits = (uint8_t) NumDigitsInLineNumber;
+    R.Address = Address;
+    R.LineNumber = CurrentLocalLine;
+    R.BytesOffset = (uint32_t) Current->Data.size();
+    R.NumBytes = K == ListingLine::Text ? 0 : (uint32_t) ByteBuffer.size();
+    Current->Data.append((const char *) ByteBuffer.data(), R.NumBytes);
+    R.TextOffset = (uint32_t) Current->Data.size();
+    R.TextSize = (uint32_t) TextSize;
+    Current->Data.append(Text, TextSize);
+    Current->Records.push_back(R);
+    if (Current->Records.size() >= ChunkRecords || Current->Data.size() >= ChunkData) {
+        submit(Current);
+        Current = nullptr;
+    }
+}
+
+void ListingWriter::submit(ListingChunk *Chunk) {
+    while (!FullChunks.push(Chunk)) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> Lock(WakeMutex);
+        Submitted = true;
+    }
+    Wake.notify_one();
+}
+
+void ListingWriter::flush() {
+    Binary.close();
+    if (!Writer.joinable()) {
+        return;
+    }
+    if (Current != nullptr) {
+        submit(Current);
+        Current = nullptr;
+    }
+    submit(nullptr);
+    Writer.join();
+    ListingChunk *Chunk;
+    while (FreeChunks.pop(Chunk)) {
+        delete Chunk;
+    }
+}
+
+void ListingWriter::write(const std::string &String) {
+    if (OFS.is_open()) {
+        addRecord(ListingLine::Text, 0, String.data(), String.size());
+    }
+    if (Binary.isOpen()) {
+        ListingLine L;
+        L.K = ListingLine::Text;
+        L.Chars = String.data();
+        L.NumChars = String.size();
+        Binary.add(L, ""s, -1);
+    }
+}
+
+void ListingWriter::list(ListingLine::Kind K, int Address, const char *Line) {
+    size_t Size = std::strlen(Line);
+    if (OFS.is_open()) {
+        addRecord(K, Address, Line, Size);
+    }
+    if (Binary.isOpen()) {
+        ListingLine L;
+        L.K = K;
+        L.InMacro = InMacro;
+        L.IncludeLevel = (uint8_t) std::min(Asm.includeLevel(), 3);
+        L.NumDigits = (uint8_t) NumDigitsInLineNumber;
+        L.Address = Address;
+        L.LineNumber = CurrentLocalLine;
+        L.Bytes = ByteBuffer.data();
+        L.NumBytes = ByteBuffer.size();
+        L.Chars = Line;
+        L.NumChars = Size;
+        int Page = Asm.Em.isMemManagerActive() ? Asm.Em.getPageForAddress((uint16_t) Address) : -1;
+        Binary.add(L, getCurrentSrcFileNameForMsg().string(), Page);
+    }
+}
+
+void ListingWriter::writerLoop() {
+    OutBuffer.reserve(OutBufferSize + 0x1000);
+    while (true) {
+        ListingChunk *Chunk;
+        if (!FullChunks.pop(Chunk)) {
+            std::unique_lock<std::mutex> Lock(WakeMutex);
+            Wake.wait(Lock, [this] { return Submitted; });
+            Submitted = false;
+            continue;
+        }
+        if (Chunk == nullptr) {
+            break;
+        }
+        for (const auto &R : Chunk->Records) {
+            render(*Chunk, R);
+        }
+        Chunk->Records.clear();
+        Chunk->Data.clear();
+        if (!FreeChunks.push(Chunk)) {
+            delete Chunk;
+        }
+    }
+    OFS.write(OutBuffer.data(), OutBuffer.size());
+    OFS.flush();
+    OutBuffer.clear();
+}
+
+void ListingWriter::render(const ListingChunk &Chunk, const ListingRecord &R) {
+    ListingLine L;
+    L.K = R.K;
+    L.InMacro = R.InMacro;
+    L.IncludeLevel = R.IncludeLevel;
+    L.NumDigits = R.NumDigits;
+    L.Address = R.Address;
+    L.LineNumber = R.LineNumber;
+    L.Bytes = (const uint8_t *) Chunk.Data.data() + R.BytesOffset;
+    L.NumBytes = R.NumBytes;
+    L.Chars = Chunk.Data.data() + R.TextOffset;
+    L.NumChars = R.TextSize;
+    formatListingLine(OutBuffer, L);
+    if (OutBuffer.size() >= OutBufferSize) {
+        OFS.write(OutBuffer.data(), OutBuffer.size());
+        OutBuffer.clear();
+    }
 }
 
 void ListingWriter::listLine(const char *Line) {
@@ -107,30 +175,7 @@ void ListingWriter::listLine(const char *Line) {
     if ((pad = PreviousAddress) == -1) {
         pad = epadres;
     }
-    std::string Prefix = printCurrentLocalLine();
-    OFS << Prefix << toHex16(pad) << ' ';
-    if (ByteBuffer.size() < 5) {
-        listBytes4();
-        if (InMacro) {
-            OFS << ">";
-        }
-        OFS << Line << endl;
-    } else if (ByteBuffer.size() < 6) {
-        listBytes5();
-        if (InMacro) {
-            OFS << ">";
-        }
-        OFS << Line << endl;
-    } else {
-        for (int i = 0; i != 12; ++i) {
-            OFS << ' ';
-        }
-        if (InMacro) {
-            OFS << ">";
-        }
-        OFS << Line << endl;
-        listBytesLong(pad, Prefix);
-    }
+    list(ListingLine::Line, pad, Line);
     epadres = Asm.Em.getCPUAddress();
     PreviousAddress = -1;
     ByteBuffer.clear();
@@ -152,24 +197,28 @@ void ListingWriter::listLineSkip(const char *Line) {
     if ((pad = PreviousAddress) == -1) {
         pad = epadres;
     }
-    OFS << printCurrentLocalLine() << toHex16(pad);
-    OFS << "~            ";
     if (!ByteBuffer.empty()) {
         Fatal("Internal error lfs"s);
     }
-    if (InMacro) {
-        OFS << ">";
-    }
-    OFS << Line << endl;
+    list(ListingLine::LineSkip, (int) pad, Line);
     epadres = Asm.Em.getCPUAddress();
     PreviousAddress = -1;
     ByteBuffer.clear();
 }
 
 void ListingWriter::addByte(uint8_t Byte) {
+    // The bytes are only listed in the last pass
+    if (pass != LASTPASS || !IsActive)
+        return;
     ByteBuffer.push_back(Byte);
 }
 
+void ListingWriter::addBytes(const uint8_t *Bytes, size_t Size) {
+    if (pass != LASTPASS || !IsActive)
+        return;
+    ByteBuffer.insert(ByteBuffer.end(), Bytes, Bytes + Size);
+}
+
 void ListingWriter::init(fs::path &FileName) {
     if (!FileName.empty()) {
         open(FileName);
@@ -179,6 +228,23 @@ void ListingWriter::init(fs::path &FileName) {
     }
 }
 
+void ListingWriter::initBinary(const fs::path &FileName) {
+    if (!FileName.empty()) {
+        if (!Binary.open(FileName.string())) {
+            Fatal("Error opening file: "s + FileName.string());
+        }
+        BinaryFileName = FileName;
+        IsActive = true;
+    }
+}
+
+optional<std::string> ListingWriter::closeBinary() {
+    if (!Binary.close()) {
+        return "Error writing file: "s + BinaryFileName.string();
+    }
+    return boost::none;
+}
+
 void ListingWriter::initPass() {
     epadres = 0;
     PreviousAddress = 0;
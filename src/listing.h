@@ -5,11 +5,40 @@
 #include <vector>
 #include <string>
 #include <stack>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "asm/common.h"
 #include "util.h"
+#include "spscring.h"
+#include "lstformat.h"
+#include "lstbin.h"
+
+
+// One listed source line or a piece of text, formatted by the writer thread
+struct ListingRecord {
+    ListingLine::Kind K;
+    bool InMacro;
+    uint8_t IncludeLevel;
+    uint8_t NumDigits;
+    int Address;
+    aint LineNumber;
+    // Bytes and text are stored in the chunk's data
+    uint32_t BytesOffset;
+    uint32_t NumBytes;
+    uint32_t TextOffset;
+    uint32_t TextSize;
+};
 
+// Records are handed over to the writer thread in chunks
+struct ListingChunk {
+    std::vector<ListingRecord> Records;
+    std::string Data;
+};
 
+// The listing is rendered and written by a background thread.
+// The assembling thread only copies each line's data into a record.
 class ListingWriter : public TextOutput {
 private:
     Assembler &Asm;
@@ -22,21 +51,60 @@ private:
     aint epadres;
     int NumDigitsInLineNumber = 0;
 
-    void listBytes4();
+    // Producer side
+    ListingChunk *Current = nullptr;
+    static const size_t ChunkRecords = 1024;
+    static const size_t ChunkData = 0x10000;
+
+    // Full chunks go to the writer, a null chunk stops it; empty ones come back
+    SPSCRing<ListingChunk *, 64> FullChunks;
+    SPSCRing<ListingChunk *, 64> FreeChunks;
+    std::thread Writer;
+    std::mutex WakeMutex;
+    std::condition_variable Wake;
+    // Set under WakeMutex by submit(), so that no notification is lost
+    bool Submitted = false;
+
+    void addRecord(ListingLine::Kind K, int Address, const char *Text, size_t TextSize);
+
+    void submit(ListingChunk *Chunk);
+
+    void startWriter();
+
+    // Text and binary listing of one line
+    void list(ListingLine::Kind K, int Address, const char *Line);
+
+    BinaryListingWriter Binary;
+    fs::path BinaryFileName;
 
-    void listBytes5();
+    // Writer thread side
+    std::string OutBuffer;
+    static const size_t OutBufferSize = 0x40000;
 
-    void listBytesLong(int pad, const std::string &Prefix);
+    void writerLoop();
 
-    std::string printCurrentLocalLine();
+    void render(const ListingChunk &Chunk, const ListingRecord &R);
 
 public:
     ListingWriter() = delete;
 
     explicit ListingWriter(Assembler &_Asm) : Asm{_Asm} {}
 
+    ~ListingWriter() override;
+
+    void write(const std::string &String);
+
+    // Wait until everything listed so far has been written to the file
+    // and finish the binary listing, e.g. before exiting on a fatal error
+    void flush();
+
     void init(fs::path &FileName) override;
 
+    void initBinary(const fs::path &FileName);
+
+    // Finish the binary listing after the last record
+    optional<std::string> closeBinary();
+
     void initPass();
 
     void listLine(const char *Line);
@@ -45,6 +113,8 @@ public:
 
     void addByte(uint8_t Byte);
 
+    void addBytes(const uint8_t *Bytes, size_t Size);
+
     void setPreviousAddress(int Value) {
         PreviousAddress = Value;
     }
@@ -53,6 +123,11 @@ public:
         OmitLine = true;
     }
 
+    // Number of macro or repeat expansions the current line is in
+    int macroDepth() const {
+        return (int) MacroStack.size();
+    }
+
     void startMacro() {
         MacroStack.push(InMacro);
         InMacro = true;
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include "lebytes.h"
+#include "lstbin.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+void putRecord(std::string &Out, const LstBinRecord &R) {
+    put32(Out, R.FileId);
+    put32(Out, R.Line);
+    put32(Out, R.BlobOffset);
+    put32(Out, R.NumBytes);
+    put32(Out, R.TextSize);
+    put16(Out, R.Address);
+    put16(Out, (uint16_t) R.Page);
+    Out += (char) R.Kind;
+    Out += (char) R.InMacro;
+    Out += (char) R.IncludeLevel;
+    Out += (char) R.NumDigits;
+}
+
+LstBinRecord getRecord(const char *P) {
+    LstBinRecord R;
+    R.FileId = get32(P);
+    R.Line = get32(P + 4);
+    R.BlobOffset = get32(P + 8);
+    R.NumBytes = get32(P + 12);
+    R.TextSize = get32(P + 16);
+    R.Address = get16(P + 20);
+    R.Page = (int16_t) get16(P + 22);
+    R.Kind = (uint8_t) P[24];
+    R.InMacro = (uint8_t) P[25];
+    R.IncludeLevel = (uint8_t) P[26];
+    R.NumDigits = (uint8_t) P[27];
+    return R;
+}
+
+// Comparisons of index entries with lookup keys for std::equal_range()
+struct AddrLess {
+    const std::vector<LstBinRecord> &Records;
+
+    bool operator()(uint32_t A, uint16_t Addr) const { return Records[A].Address < Addr; }
+
+    bool operator()(uint16_t Addr, uint32_t A) const { return Addr < Records[A].Address; }
+};
+
+struct LineLess {
+    const std::vector<LstBinRecord> &Records;
+    using Key = std::pair<uint32_t, uint32_t>;
+
+    Key key(uint32_t A) const { return {Records[A].FileId, Records[A].Line}; }
+
+    bool operator()(uint32_t A, const Key &K) const { return key(A) < K; }
+
+    bool operator()(const Key &K, uint32_t A) const { return K < key(A); }
+};
+
+} // namespace
+
+bool BinaryListingWriter::open(const std::string &FileName) {
+    close();
+    Records.clear();
+    Files.clear();
+    FileIds.clear();
+    LastFile.clear();
+    LastFileId = LstBinRecord::NoFile;
+    BlobSize = 0;
+    OFS.open(FileName, std::ios::binary | std::ios::trunc);
+    if (!OFS.is_open()) {
+        return false;
+    }
+    // Filled in by close()
+    const char Header[LstBinHeaderSize] = {};
+    OFS.write(Header, LstBinHeaderSize);
+    return !OFS.fail();
+}
+
+uint32_t BinaryListingWriter::fileId(const std::string &FileName) {
+    // Consecutive lines nearly always come from the same file
+    if (LastFileId != LstBinRecord::NoFile && FileName == LastFile) {
+        return LastFileId;
+    }
+    auto It = FileIds.find(FileName);
+    if (It == FileIds.end()) {
+        It = FileIds.emplace(FileName, (uint32_t) Files.size()).first;
+        Files.push_back(FileName);
+    }
+    LastFile = FileName;
+    LastFileId = It->second;
+    return LastFileId;
+}
+
+void BinaryListingWriter::add(const ListingLine &L, const std::string &FileName, int Page) {
+    LstBinRecord R;
+    bool IsText = L.K == ListingLine::Text;
+    R.FileId = IsText ? LstBinRecord::NoFile : fileId(FileName);
+    R.Line = (uint32_t) L.LineNumber;
+    R.BlobOffset = (uint32_t) BlobSize;
+    R.NumBytes = (uint32_t) L.NumBytes;
+    R.TextSize = (uint32_t) L.NumChars;
+    R.Address = (uint16_t) L.Address;
+    R.Page = (int16_t) (IsText ? -1 : Page);
+    R.Kind = L.K;
+    R.InMacro = L.InMacro;
+    R.IncludeLevel = L.IncludeLevel;
+    R.NumDigits = L.NumDigits;
+    OFS.write((const char *) L.Bytes, L.NumBytes);
+    OFS.write(L.Chars, L.NumChars);
+    BlobSize += L.NumBytes + L.NumChars;
+    Records.push_back(R);
+}
+
+bool BinaryListingWriter::close() {
+    if (!OFS.is_open()) {
+        return true;
+    }
+    uint64_t BlobOffset = LstBinHeaderSize;
+    uint64_t RecordsOffset = BlobOffset + BlobSize;
+    std::string Out;
+    Out.reserve(Records.size() * (LstBinRecord::Size + 8));
+    for (const auto &R : Records) {
+        putRecord(Out, R);
+    }
+
+    uint64_t FilesOffset = RecordsOffset + Out.size();
+    for (const auto &F : Files) {
+        put32(Out, (uint32_t) F.size());
+        Out += F;
+    }
+
+    std::vector<uint32_t> Indexed;
+    for (uint32_t i = 0; i < Records.size(); i++) {
+        if (Records[i].Kind != ListingLine::Text) {
+            Indexed.push_back(i);
+        }
+    }
+    std::vector<uint32_t> AddrIndex{Indexed};
+    std::sort(AddrIndex.begin(), AddrIndex.end(), [this](uint32_t A, uint32_t B) {
+        const auto &RA = Records[A];
+        const auto &RB = Records[B];
+        if (RA.Address != RB.Address)
+            return RA.Address < RB.Address;
+        if (RA.Page != RB.Page)
+            return RA.Page < RB.Page;
+        return A < B;
+    });
+    uint64_t AddrIndexOffset = RecordsOffset + Out.size();
+    for (auto i : AddrIndex) {
+        put32(Out, i);
+    }
+
+    // Records of one file are already in line order unless the file was included twice
+    std::vector<uint32_t> &LineIndex = Indexed;
+    std::sort(LineIndex.begin(), LineIndex.end(), [this](uint32_t A, uint32_t B) {
+        const auto &RA = Records[A];
+        const auto &RB = Records[B];
+        if (RA.FileId != RB.FileId)
+            return RA.FileId < RB.FileId;
+        if (RA.Line != RB.Line)
+            return RA.Line < RB.Line;
+        return A < B;
+    });
+    uint64_t LineIndexOffset = RecordsOffset + Out.size();
+    for (auto i : LineIndex) {
+        put32(Out, i);
+    }
+    OFS.write(Out.data(), Out.size());
+
+    std::string Header{LstBinMagic, sizeof(LstBinMagic)};
+    put32(Header, LstBinVersion);
+    put32(Header, (uint32_t) LstBinRecord::Size);
+    put32(Header, (uint32_t) Records.size());
+    put32(Header, (uint32_t) Files.size());
+    put32(Header, (uint32_t) LineIndex.size());
+    put64(Header, BlobOffset);
+    put64(Header, RecordsOffset);
+    put64(Header, FilesOffset);
+    put64(Header, AddrIndexOffset);
+    put64(Header, LineIndexOffset);
+    put64(Header, BlobSize);
+    OFS.seekp(0);
+    OFS.write(Header.data(), Header.size());
+    OFS.close();
+    Records.clear();
+    return !OFS.fail();
+}
+
+std::string BinaryListingReader::load(const std::string &FileName) {
+    std::ifstream IFS(FileName, std::ios::binary);
+    if (!IFS) {
+        return "Error opening file "s + FileName;
+    }
+    std::string Data{std::istreambuf_iterator<char>(IFS), std::istreambuf_iterator<char>()};
+    if (Data.size() < LstBinHeaderSize || std::memcmp(Data.data(), LstBinMagic, sizeof(LstBinMagic)) != 0) {
+        return FileName + " is not a binary listing"s;
+    }
+    const char *H = Data.data() + sizeof(LstBinMagic);
+    if (get32(H) != LstBinVersion || get32(H + 4) != LstBinRecord::Size) {
+        return "Unsupported binary listing version in "s + FileName;
+    }
+    uint32_t NumRecords = get32(H + 8);
+    uint32_t NumFiles = get32(H + 12);
+    uint32_t NumIndexed = get32(H + 16);
+    uint64_t BlobOffset = get64(H + 20);
+    uint64_t RecordsOffset = get64(H + 28);
+    uint64_t FilesOffset = get64(H + 36);
+    uint64_t AddrIndexOffset = get64(H + 44);
+    uint64_t LineIndexOffset = get64(H + 52);
+    uint64_t BlobSize = get64(H + 60);
+
+    auto Fits = [&Data](uint64_t Offset, uint64_t Size) {
+        return Offset <= Data.size() && Size <= Data.size() - Offset;
+    };
+    if (!Fits(BlobOffset, BlobSize) ||
+        !Fits(RecordsOffset, (uint64_t) NumRecords * LstBinRecord::Size) ||
+        !Fits(AddrIndexOffset, (uint64_t) NumIndexed * 4) ||
+        !Fits(LineIndexOffset, (uint64_t) NumIndexed * 4) ||
+        !Fits(FilesOffset, 0)) {
+        return FileName + " is truncated"s;
+    }
+
+    Records.clear();
+    Records.reserve(NumRecords);
+    for (uint32_t i = 0; i < NumRecords; i++) {
+        auto R = getRecord(Data.data() + RecordsOffset + (uint64_t) i * LstBinRecord::Size);
+        if (!Fits(BlobOffset + R.BlobOffset, (uint64_t) R.NumBytes + R.TextSize)) {
+            return FileName + " is truncated"s;
+        }
+        Records.push_back(R);
+    }
+
+    Files.clear();
+    uint64_t P = FilesOffset;
+    for (uint32_t i = 0; i < NumFiles; i++) {
+        if (!Fits(P, 4) || !Fits(P + 4, get32(Data.data() + P))) {
+            return FileName + " is truncated"s;
+        }
+        uint32_t Len = get32(Data.data() + P);
+        Files.emplace_back(Data.data() + P + 4, Len);
+        P += 4 + Len;
+    }
+
+    AddrIndex.resize(NumIndexed);
+    LineIndex.resize(NumIndexed);
+    for (uint32_t i = 0; i < NumIndexed; i++) {
+        AddrIndex[i] = get32(Data.data() + AddrIndexOffset + i * 4);
+        LineIndex[i] = get32(Data.data() + LineIndexOffset + i * 4);
+        if (AddrIndex[i] >= NumRecords || LineIndex[i] >= NumRecords) {
+            return FileName + " has a broken index"s;
+        }
+    }
+
+    Blob = Data.substr(BlobOffset, BlobSize);
+    return ""s;
+}
+
+ListingLine BinaryListingReader::line(size_t i) const {
+    const auto &R = Records[i];
+    ListingLine L;
+    L.K = (ListingLine::Kind) R.Kind;
+    L.InMacro = R.InMacro != 0;
+    L.IncludeLevel = R.IncludeLevel;
+    L.NumDigits = R.NumDigits;
+    L.Address = R.Address;
+    L.LineNumber = (aint) R.Line;
+    L.Bytes = (const uint8_t *) Blob.data() + R.BlobOffset;
+    L.NumBytes = R.NumBytes;
+    L.Chars = Blob.data() + R.BlobOffset + R.NumBytes;
+    L.NumChars = R.TextSize;
+    return L;
+}
+
+std::vector<uint32_t> BinaryListingReader::findAddress(uint16_t Addr, int Page) const {
+    auto Range = std::equal_range(AddrIndex.begin(), AddrIndex.end(), Addr, AddrLess{Records});
+    std::vector<uint32_t> Result;
+    for (auto It = Range.first; It != Range.second; ++It) {
+        if (Page < 0 || Records[*It].Page == Page) {
+            Result.push_back(*It);
+        }
+    }
+    return Result;
+}
+
+std::vector<uint32_t> BinaryListingReader::findLine(const std::string &FileName, uint32_t Line) const {
+    std::vector<uint32_t> Result;
+    auto F = std::find(Files.begin(), Files.end(), FileName);
+    if (F == Files.end()) {
+        return Result;
+    }
+    auto Key = std::make_pair((uint32_t) (F - Files.begin()), Line);
+    auto Range = std::equal_range(LineIndex.begin(), LineIndex.end(), Key, LineLess{Records});
+    Result.assign(Range.first, Range.second);
+    return Result;
+}
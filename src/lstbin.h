@@ -0,0 +1,102 @@
+#ifndef SJASMPLUS_LSTBIN_H
+#define SJASMPLUS_LSTBIN_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lstformat.h"
+
+// Binary listing (--lst-bin), all integers are little-endian:
+//
+//   Header     magic "SJLSTBIN", uint32 version, uint32 record size,
+//              uint32 number of records, files and indexed records,
+//              uint64 offsets of the sections below and the blob size
+//   Blob       listed bytes followed by the text of every record
+//   Records    fixed-size records in listing order
+//   Files      uint32 length and the name of each source file
+//   AddrIndex  uint32 record numbers sorted by address, page, record
+//   LineIndex  uint32 record numbers sorted by file, line, record
+//
+// Only source lines are indexed, text records (errors, the label table)
+// have no file and no page.
+struct LstBinRecord {
+    static const uint32_t NoFile = 0xffffffff;
+    static const size_t Size = 28;
+
+    uint32_t FileId;
+    uint32_t Line;
+    uint32_t BlobOffset;
+    uint32_t NumBytes;
+    uint32_t TextSize;
+    uint16_t Address;
+    int16_t Page; // -1 without a device
+    uint8_t Kind;
+    uint8_t InMacro;
+    uint8_t IncludeLevel;
+    uint8_t NumDigits;
+};
+
+const char LstBinMagic[8] = {'S', 'J', 'L', 'S', 'T', 'B', 'I', 'N'};
+const uint32_t LstBinVersion = 1;
+const size_t LstBinHeaderSize = 8 + 4 * 5 + 8 * 6;
+
+// Collects records during the last pass and writes the indexes on close()
+class BinaryListingWriter {
+private:
+    std::ofstream OFS;
+    std::vector<LstBinRecord> Records;
+    std::vector<std::string> Files;
+    std::unordered_map<std::string, uint32_t> FileIds;
+    std::string LastFile;
+    uint32_t LastFileId = LstBinRecord::NoFile;
+    uint64_t BlobSize = 0;
+
+    uint32_t fileId(const std::string &FileName);
+
+public:
+    ~BinaryListingWriter() {
+        close();
+    }
+
+    bool open(const std::string &FileName);
+
+    bool isOpen() const { return OFS.is_open(); }
+
+    void add(const ListingLine &L, const std::string &FileName, int Page);
+
+    // Write the records, file names and indexes after the blob. False if the
+    // file could not be written completely
+    bool close();
+};
+
+class BinaryListingReader {
+private:
+    std::vector<LstBinRecord> Records;
+    std::vector<std::string> Files;
+    std::vector<uint32_t> AddrIndex;
+    std::vector<uint32_t> LineIndex;
+    std::string Blob;
+
+public:
+    // Returns an error message, empty on success
+    std::string load(const std::string &FileName);
+
+    size_t numRecords() const { return Records.size(); }
+
+    const LstBinRecord &record(size_t i) const { return Records[i]; }
+
+    // The record in the form accepted by formatListingLine()
+    ListingLine line(size_t i) const;
+
+    const std::vector<std::string> &files() const { return Files; }
+
+    // Record numbers of the source lines listed at Addr, on any page if Page < 0
+    std::vector<uint32_t> findAddress(uint16_t Addr, int Page) const;
+
+    std::vector<uint32_t> findLine(const std::string &FileName, uint32_t Line) const;
+};
+
+#endif //SJASMPLUS_LSTBIN_H
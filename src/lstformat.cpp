@@ -0,0 +1,119 @@
+#include <algorithm>
+#include "lstformat.h"
+
+namespace {
+
+// Fits the line number, include markers, address and 32 bytes in hex
+const size_t LineBufSize = 96;
+
+// Two hex digits for each byte value
+struct HexPairTable {
+    char Pairs[256][2];
+
+    HexPairTable() {
+        const char Digits[] = "0123456789ABCDEF";
+        for (int i = 0; i < 256; i++) {
+            Pairs[i][0] = Digits[i >> 4];
+            Pairs[i][1] = Digits[i & 15];
+        }
+    }
+};
+
+const HexPairTable HexPairs;
+
+char *putHex8(char *P, uint8_t Byte) {
+    P[0] = HexPairs.Pairs[Byte][0];
+    P[1] = HexPairs.Pairs[Byte][1];
+    return P + 2;
+}
+
+char *putHex16(char *P, int Word) {
+    P = putHex8(P, (uint8_t) ((Word >> 8) & 0xff));
+    return putHex8(P, (uint8_t) (Word & 0xff));
+}
+
+// Line number padded to L.NumDigits followed by include level markers
+char *putLineNumber(char *P, const ListingLine &L) {
+    aint v = L.LineNumber;
+    int Digits = L.NumDigits >= 1 && L.NumDigits <= 6 ? L.NumDigits : 7;
+    aint Divisor = 1;
+    for (int i = 1; i < Digits; i++) {
+        Divisor *= 10;
+    }
+    for (; Divisor > 0; Divisor /= 10) {
+        *P++ = (char) ('0' + v / Divisor);
+        v %= Divisor;
+    }
+    *P++ = (L.IncludeLevel > 0 ? '+' : ' ');
+    *P++ = (L.IncludeLevel > 1 ? '+' : ' ');
+    *P++ = (L.IncludeLevel > 2 ? '+' : ' ');
+    return P;
+}
+
+// Bytes which did not fit on the source line, 32 per line
+void listBytesLong(std::string &Out, int pad, const uint8_t *Bytes, size_t NumBytes,
+                   const char *Prefix, const char *PrefixEnd) {
+    char Buf[LineBufSize];
+    size_t i = 0;
+    while (i < NumBytes) {
+        char *P = std::copy(Prefix, PrefixEnd, Buf);
+        P = putHex16(P, pad);
+        *P++ = ' ';
+        int t = 0;
+        while (i < NumBytes && t < 32) {
+            P = putHex8(P, Bytes[i]);
+            ++i;
+            ++t;
+        }
+        *P++ = '\n';
+        Out.append(Buf, P);
+        pad += 32;
+    }
+}
+
+} // namespace
+
+void formatListingLine(std::string &Out, const ListingLine &L) {
+    if (L.K == ListingLine::Text) {
+        Out.append(L.Chars, L.NumChars);
+        return;
+    }
+    char Buf[LineBufSize];
+    char *PrefixEnd = putLineNumber(Buf, L);
+    char *P = putHex16(PrefixEnd, L.Address);
+    bool Long = false;
+    if (L.K == ListingLine::LineSkip) {
+        P = std::copy_n("~            ", 13, P);
+    } else if (L.NumBytes < 5) {
+        *P++ = ' ';
+        for (size_t i = 0; i < L.NumBytes; i++) {
+            P = putHex8(P, L.Bytes[i]);
+            *P++ = ' ';
+        }
+        for (auto i = L.NumBytes; i < 4; i++) {
+            *P++ = ' ';
+            *P++ = ' ';
+            *P++ = ' ';
+        }
+    } else if (L.NumBytes < 6) {
+        *P++ = ' ';
+        for (size_t i = 0; i < L.NumBytes; i++) {
+            P = putHex8(P, L.Bytes[i]);
+        }
+        *P++ = ' ';
+        *P++ = ' ';
+    } else {
+        *P++ = ' ';
+        P = std::fill_n(P, 12, ' ');
+        Long = true;
+    }
+    if (L.InMacro) {
+        *P++ = '>';
+    }
+    Out.append(Buf, P);
+    Out.append(L.Chars, L.NumChars);
+    Out += '\n';
+    if (Long) {
+        listBytesLong(Out, L.Address, L.Bytes, L.NumBytes, Buf, PrefixEnd);
+    }
+}
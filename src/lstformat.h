@@ -0,0 +1,31 @@
+#ifndef SJASMPLUS_LSTFORMAT_H
+#define SJASMPLUS_LSTFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "asm/common.h"
+
+// Everything needed to format one entry of the text listing.
+// Shared by the assembler and the binary listing renderer.
+struct ListingLine {
+    enum Kind : uint8_t {
+        Line, LineSkip, Text
+    };
+    Kind K = Line;
+    bool InMacro = false;
+    uint8_t IncludeLevel = 0;
+    uint8_t NumDigits = 1;
+    int Address = 0;
+    aint LineNumber = 0;
+    const uint8_t *Bytes = nullptr;
+    size_t NumBytes = 0;
+    const char *Chars = nullptr;
+    size_t NumChars = 0;
+};
+
+// Append the entry to Out in the classic listing format
+void formatListingLine(std::string &Out, const ListingLine &L);
+
+#endif //SJASMPLUS_LSTFORMAT_H
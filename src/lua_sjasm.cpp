@@ -8,6 +8,7 @@
 #endif
 
 #include <cstring>
+#include <vector>
 
 #include "lua_support.h"
 
@@ -28,7 +29,7 @@ TOLUA_API int tolua_sjasm_open(lua_State *tolua_S);
 using namespace options;
 
 // FIXME: errors.cpp
-extern Assembler *Asm;
+extern thread_local Assembler *Asm;
 
 /* function to register type */
 static void tolua_reg_types(lua_State *tolua_S) {
@@ -315,6 +316,7 @@ static int tolua_sjasm_zx_save_snapshot_sna12800(lua_State *tolua_S) {
         char *fname = ((char *) tolua_tostring(tolua_S, 1, 0));
         unsigned short start = ((unsigned short) tolua_tonumber(tolua_S, 2, 0));
         {
+            Asm->Saves.waitAll();
             int tolua_ret = (int) zx::saveSNA(Asm->Em.getMemModel(), fname, start);
             tolua_pushnumber(tolua_S, (lua_Number) tolua_ret);
         }
@@ -355,7 +357,8 @@ static int tolua_sjasm_sj_exit00(lua_State *tolua_S) {
     {
         int p = ((int) tolua_tonumber(tolua_S, 1, 1));
         {
-            exit(p);
+            Asm->Listing.flush();
+            throw AssemblyAborted{p};
         }
     }
     return 0;
@@ -617,6 +620,74 @@ static int tolua_sjasm_sj_set_slot00(lua_State *tolua_S) {
 
 #endif //#ifndef TOLUA_DISABLE
 
+/* function: LuaIsUnusedBlock */
+#ifndef TOLUA_DISABLE_tolua_sjasm_sj_is_unused_block00
+
+static int tolua_sjasm_sj_is_unused_block00(lua_State *tolua_S) {
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (
+            !tolua_isnumber(tolua_S, 1, 0, &tolua_err) ||
+            !tolua_isnumber(tolua_S, 2, 0, &tolua_err) ||
+            !tolua_isnoobj(tolua_S, 3, &tolua_err)
+            )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        unsigned int start = ((unsigned int) tolua_tonumber(tolua_S, 1, 0));
+        unsigned int size = ((unsigned int) tolua_tonumber(tolua_S, 2, 0));
+        {
+            bool tolua_ret = (bool) LuaIsUnusedBlock(start, size);
+            tolua_pushboolean(tolua_S, (bool) tolua_ret);
+        }
+    }
+    return 1;
+#ifndef TOLUA_RELEASE
+    tolua_lerror:
+    tolua_error(tolua_S, "#ferror in function 'is_unused_block'.", &tolua_err);
+    return 0;
+#endif
+}
+
+#endif //#ifndef TOLUA_DISABLE
+
+/* function: LuaFindUnusedBlock */
+#ifndef TOLUA_DISABLE_tolua_sjasm_sj_find_unused_block00
+
+static int tolua_sjasm_sj_find_unused_block00(lua_State *tolua_S) {
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (
+            !tolua_isnumber(tolua_S, 1, 0, &tolua_err) ||
+            !tolua_isnumber(tolua_S, 2, 0, &tolua_err) ||
+            !tolua_isnumber(tolua_S, 3, 1, &tolua_err) ||
+            !tolua_isboolean(tolua_S, 4, 1, &tolua_err) ||
+            !tolua_isnoobj(tolua_S, 5, &tolua_err)
+            )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        unsigned int start = ((unsigned int) tolua_tonumber(tolua_S, 1, 0));
+        unsigned int size = ((unsigned int) tolua_tonumber(tolua_S, 2, 0));
+        unsigned int limit = ((unsigned int) tolua_tonumber(tolua_S, 3, 0));
+        bool backwards = ((bool) tolua_toboolean(tolua_S, 4, false));
+        {
+            int tolua_ret = (int) LuaFindUnusedBlock(start, size, limit, backwards);
+            tolua_pushnumber(tolua_S, (lua_Number) tolua_ret);
+        }
+    }
+    return 1;
+#ifndef TOLUA_RELEASE
+    tolua_lerror:
+    tolua_error(tolua_S, "#ferror in function 'find_unused_block'.", &tolua_err);
+    return 0;
+#endif
+}
+
+#endif //#ifndef TOLUA_DISABLE
+
 /* function: MemGetByte */
 #ifndef TOLUA_DISABLE_tolua_sjasm_sj_get_byte00
 
@@ -735,6 +806,75 @@ static int tolua_sjasm_sj_add_word00(lua_State *tolua_S) {
 
 #endif //#ifndef TOLUA_DISABLE
 
+/* add_bytes, get_bytes and emit_table are bound by hand: tolua++ has no
+   binding for strings with zero bytes or for tables of numbers */
+
+/* function: LuaAddBytes */
+static int tolua_sjasm_sj_add_bytes00(lua_State *tolua_S) {
+    size_t Size;
+    const char *Bytes = luaL_checklstring(tolua_S, 1, &Size);
+    emitSpan((const uint8_t *) Bytes, Size);
+    return 0;
+}
+
+/* function: LuaGetBytes */
+static int tolua_sjasm_sj_get_bytes00(lua_State *tolua_S) {
+    auto Start = (aint) luaL_checknumber(tolua_S, 1);
+    auto Size = (aint) luaL_checknumber(tolua_S, 2);
+    auto Bytes = LuaGetBytes(Start, Size);
+    lua_pushlstring(tolua_S, Bytes.data(), Bytes.size());
+    return 1;
+}
+
+/* function: LuaEmitTable */
+static int tolua_sjasm_sj_emit_table00(lua_State *tolua_S) {
+    luaL_checktype(tolua_S, 1, LUA_TTABLE);
+    std::vector<uint8_t> Bytes(lua_objlen(tolua_S, 1));
+    for (size_t i = 0; i < Bytes.size(); i++) {
+        lua_rawgeti(tolua_S, 1, (int) i + 1);
+        if (!lua_isnumber(tolua_S, -1)) {
+            return luaL_error(tolua_S, "emit_table: element %d is not a number", (int) i + 1);
+        }
+        Bytes[i] = (uint8_t) (aint) lua_tonumber(tolua_S, -1);
+        lua_pop(tolua_S, 1);
+    }
+    emitSpan(Bytes.data(), Bytes.size());
+    return 0;
+}
+
+/* function: LuaFill */
+#ifndef TOLUA_DISABLE_tolua_sjasm_sj_fill00
+
+static int tolua_sjasm_sj_fill00(lua_State *tolua_S) {
+#ifndef TOLUA_RELEASE
+    tolua_Error tolua_err;
+    if (
+            !tolua_isnumber(tolua_S, 1, 0, &tolua_err) ||
+            !tolua_isnumber(tolua_S, 2, 0, &tolua_err) ||
+            !tolua_isnumber(tolua_S, 3, 0, &tolua_err) ||
+            !tolua_isnoobj(tolua_S, 4, &tolua_err)
+            )
+        goto tolua_lerror;
+    else
+#endif
+    {
+        unsigned int start = ((unsigned int) tolua_tonumber(tolua_S, 1, 0));
+        unsigned int size = ((unsigned int) tolua_tonumber(tolua_S, 2, 0));
+        int byte = ((int) tolua_tonumber(tolua_S, 3, 0));
+        {
+            LuaFill(start, size, byte);
+        }
+    }
+    return 0;
+#ifndef TOLUA_RELEASE
+    tolua_lerror:
+    tolua_error(tolua_S, "#ferror in function 'fill'.", &tolua_err);
+    return 0;
+#endif
+}
+
+#endif //#ifndef TOLUA_DISABLE
+
 /* function: LuaCalculate */
 #ifndef TOLUA_DISABLE_tolua_sjasm_sj_calc00
 
@@ -951,10 +1091,16 @@ TOLUA_API int tolua_sjasm_open(lua_State *tolua_S) {
     tolua_function(tolua_S, "get_device", tolua_sjasm_sj_get_device00);
     tolua_function(tolua_S, "set_page", tolua_sjasm_sj_set_page00);
     tolua_function(tolua_S, "set_slot", tolua_sjasm_sj_set_slot00);
+    tolua_function(tolua_S, "is_unused_block", tolua_sjasm_sj_is_unused_block00);
+    tolua_function(tolua_S, "find_unused_block", tolua_sjasm_sj_find_unused_block00);
     tolua_function(tolua_S, "get_byte", tolua_sjasm_sj_get_byte00);
     tolua_function(tolua_S, "get_word", tolua_sjasm_sj_get_word00);
     tolua_function(tolua_S, "add_byte", tolua_sjasm_sj_add_byte00);
     tolua_function(tolua_S, "add_word", tolua_sjasm_sj_add_word00);
+    tolua_function(tolua_S, "add_bytes", tolua_sjasm_sj_add_bytes00);
+    tolua_function(tolua_S, "get_bytes", tolua_sjasm_sj_get_bytes00);
+    tolua_function(tolua_S, "fill", tolua_sjasm_sj_fill00);
+    tolua_function(tolua_S, "emit_table", tolua_sjasm_sj_emit_table00);
     tolua_function(tolua_S, "calc", tolua_sjasm_sj_calc00);
     tolua_function(tolua_S, "parse_line", tolua_sjasm_sj_parse_line00);
     tolua_function(tolua_S, "parse_code", tolua_sjasm_sj_parse_code00);
@@ -1,24 +1,91 @@
+#include <functional>
+#include <map>
+
 #include "errors.h"
 #include "lua_support.h"
 
-lua_State *LUA;
-int LuaLine = -1;
+using namespace std::string_literals;
+
+thread_local lua_State *LUA;
+thread_local int LuaLine = -1;
+
+namespace {
+
+struct LuaChunk {
+    std::string Script;
+    int Ref;
+};
+
+// By position and hash of the script
+thread_local std::map<std::string, LuaChunk> LuaChunks;
+
+// print() of Lua writing to the messages, which go to the client of a
+// --server or to the output of the target with --targets
+int luaPrint(lua_State *L) {
+    int N = lua_gettop(L);
+    std::string Line;
+    lua_getglobal(L, "tostring");
+    for (int i = 1; i <= N; i++) {
+        lua_pushvalue(L, -1);
+        lua_pushvalue(L, i);
+        lua_call(L, 1, 1);
+        size_t Size;
+        const char *S = lua_tolstring(L, -1, &Size);
+        if (!S) {
+            return luaL_error(L, LUA_QL("tostring") " must return a string to " LUA_QL("print"));
+        }
+        if (i > 1) {
+            Line += '\t';
+        }
+        Line.append(S, Size);
+        lua_pop(L, 1);
+    }
+    messageStream() << Line << std::endl;
+    return 0;
+}
+
+} // namespace
 
 void LuaFatalError(lua_State *L) {
     Fatal((char *) lua_tostring(L, -1));
 }
 
 void initLUA() {
+    LuaLine = -1;
     LUA = lua_open();
     lua_atpanic(LUA, (lua_CFunction) LuaFatalError);
     luaL_openlibs(LUA);
+    lua_register(LUA, "print", luaPrint);
     luaopen_pack(LUA);
 
     tolua_sjasm_open(LUA);
 }
 
 void shutdownLUA() {
-    lua_close(LUA);
+    LuaChunks.clear();
+    if (LUA) {
+        lua_close(LUA);
+        LUA = nullptr;
+    }
+}
+
+int loadLuaChunk(const std::string &Position, const std::string &Script) {
+    auto Key = Position + ":"s + std::to_string(std::hash<std::string>{}(Script));
+    auto It = LuaChunks.find(Key);
+    if (It == LuaChunks.end() || It->second.Script != Script) {
+        // The position in the chunk name tells the blocks apart in the profile
+        int Err = luaL_loadbuffer(LUA, Script.data(), Script.size(), ("script "s + Position).c_str());
+        if (Err) {
+            return Err;
+        }
+        if (It != LuaChunks.end()) {
+            luaL_unref(LUA, LUA_REGISTRYINDEX, It->second.Ref);
+            LuaChunks.erase(It);
+        }
+        It = LuaChunks.emplace(Key, LuaChunk{Script, luaL_ref(LUA, LUA_REGISTRYINDEX)}).first;
+    }
+    lua_rawgeti(LUA, LUA_REGISTRYINDEX, It->second.Ref);
+    return 0;
 }
 
 void LuaShellExec(char *command) {
@@ -17,14 +17,22 @@ extern "C" {
 #include "lua_lpack.h"
 }
 
+#include <string>
+
 #include "lua_sjasm.h"
 
-extern lua_State *LUA;
-extern int LuaLine;
+extern thread_local lua_State *LUA;
+extern thread_local int LuaLine;
 
 void initLUA();
 void shutdownLUA();
 
+// Push the compiled Script of the LUA block at Position (file:line). Chunks are
+// compiled once and reused by the later passes and repeated expansions of the
+// same text. Returns non-zero with the error message pushed if Script does not
+// compile.
+int loadLuaChunk(const std::string &Position, const std::string &Script);
+
 void LuaShellExec(char *command);
 
 #endif //SJASMPLUS_LUA_SUPPORT_H
@@ -8,6 +8,124 @@
 
 using boost::algorithm::to_upper_copy;
 
+namespace {
+
+// Copy a chunk which does not cross a page boundary into the page storage
+void copyChunk(uint8_t *Mem, UsageBitmap &Usage, BlockSummary &Blocks, size_t Offset,
+               const uint8_t *Src, size_t Size, bool Ephemeral, bool NoOverwrite) {
+    Blocks.mark(Offset, Size, Ephemeral);
+    if (NoOverwrite) {
+        for (size_t i = 0; i < Size; i++) {
+            if (!Usage.test(Offset + i)) {
+                Mem[Offset + i] = Src[i];
+                if (!Ephemeral)
+                    Usage.set(Offset + i);
+            }
+        }
+        return;
+    }
+    std::memcpy(Mem + Offset, Src, Size);
+    if (!Ephemeral) {
+        Usage.setRange(Offset, Size);
+    }
+}
+
+void fillChunk(uint8_t *Mem, UsageBitmap &Usage, BlockSummary &Blocks, size_t Offset,
+               uint8_t Byte, size_t Size, bool Ephemeral, bool NoOverwrite) {
+    Blocks.mark(Offset, Size, Ephemeral);
+    if (NoOverwrite) {
+        for (size_t i = 0; i < Size; i++) {
+            if (!Usage.test(Offset + i)) {
+                Mem[Offset + i] = Byte;
+                if (!Ephemeral)
+                    Usage.set(Offset + i);
+            }
+        }
+        return;
+    }
+    std::memset(Mem + Offset, Byte, Size);
+    if (!Ephemeral) {
+        Usage.setRange(Offset, Size);
+    }
+}
+
+// Byte masks which keep the bytes whose usage bits are set in the index,
+// stored in memory order so that they match 8 bytes loaded with memcpy()
+struct UsedByteMasks {
+    uint64_t Masks[256];
+
+    UsedByteMasks() {
+        for (int i = 0; i < 256; i++) {
+            uint8_t Bytes[8];
+            for (int b = 0; b < 8; b++) {
+                Bytes[b] = (i & (1 << b)) ? 0xff : 0;
+            }
+            std::memcpy(&Masks[i], Bytes, 8);
+        }
+    }
+};
+
+const UsedByteMasks ByteMasks;
+
+} // namespace
+
+void clearEphemeralBytes(uint8_t *Mem, const UsageBitmap &Usage, BlockSummary &Blocks) {
+    const size_t WordsPerBlock = BlockSummary::BlockSize / 64;
+    Blocks.forEachEphemeral([&](size_t Block) {
+        for (size_t w = Block * WordsPerBlock; w < (Block + 1) * WordsPerBlock; w++) {
+            uint64_t Used = Usage.word(w);
+            if (Used == ~(uint64_t) 0)
+                continue;
+            // Mask 8 bytes at a time
+            for (int k = 0; k < 8; k++) {
+                uint8_t *P = Mem + w * 64 + k * 8;
+                uint64_t Data;
+                std::memcpy(&Data, P, 8);
+                Data &= ByteMasks.Masks[(Used >> (k * 8)) & 0xff];
+                std::memcpy(P, &Data, 8);
+            }
+        }
+    });
+    Blocks.resetEphemeral();
+}
+
+void clearDirtyBlocks(uint8_t *Mem, UsageBitmap &Usage, BlockSummary &Blocks) {
+    const size_t WordsPerBlock = BlockSummary::BlockSize / 64;
+    Blocks.forEachDirty([&](size_t Block) {
+        std::memset(Mem + Block * BlockSummary::BlockSize, 0, BlockSummary::BlockSize);
+        Usage.clearWords(Block * WordsPerBlock, WordsPerBlock);
+    });
+    Blocks.reset();
+}
+
+size_t MemModel::runLength(uint16_t Addr, size_t Max, bool Used, bool Backwards) {
+    size_t Count = 0;
+    while (Count < Max) {
+        const uint64_t *Chunk = getUsageChunk(Addr / 0x4000);
+        auto Bit = Addr % 0x4000;
+        // Bits which differ from the run's value become ones
+        uint64_t Word = Chunk[Bit / 64] ^ (Used ? ~(uint64_t) 0 : 0);
+        auto Pos = Bit % 64;
+        size_t N;
+        bool RunEnds;
+        if (!Backwards) {
+            Word >>= Pos;
+            RunEnds = Word != 0;
+            N = RunEnds ? lowestSetBit(Word) : 64 - Pos;
+        } else {
+            Word <<= 63 - Pos;
+            RunEnds = Word != 0;
+            N = RunEnds ? 63 - highestSetBit(Word) : Pos + 1;
+        }
+        N = std::min(N, Max - Count);
+        Count += N;
+        if (RunEnds)
+            break;
+        Addr = (uint16_t) (Backwards ? Addr - N : Addr + N);
+    }
+    return Count;
+}
+
 optional<uint16_t>
 MemModel::findUnusedBlock(uint16_t Start, uint16_t Size,
         uint16_t SearchLimit, bool Backwards) {
@@ -21,22 +139,105 @@ MemModel::findUnusedBlock(uint16_t Start, uint16_t Size,
             : (SearchLimit == 0 ? 0x10000 - Size: Start + SearchLimit);
     int SearchStart = Start;
     while (Backwards ? SearchStart > End : SearchStart < End) {
-        uint16_t count = 0;
-        while (!usedAddr((uint16_t) (SearchStart + Step * count))) {
-            count++;
-            if (count == Size) {
-                return Backwards ? (SearchStart - (Size - 1)) : SearchStart;
-            }
+        auto Free = runLength((uint16_t) SearchStart, Size, false, Backwards);
+        if (Free == Size) {
+            return (uint16_t) (Backwards ? (SearchStart - (Size - 1)) : SearchStart);
         }
-        SearchStart += Step * count + Step;
+        // Skip the free bytes and the whole used run which follows them
+        SearchStart += Step * (int) Free;
+        int Distance = Backwards ? SearchStart - End : End - SearchStart;
+        auto Used = runLength((uint16_t) SearchStart, (size_t) std::min(std::max(Distance, 1), 0x10000),
+                true, Backwards);
+        SearchStart += Step * (int) Used;
     }
     return boost::none;
 }
 
-ZXMemModel::ZXMemModel(const std::string &Name, int NPages) : MemModel(Name) {
+void PlainMemModel::writeSpan(uint16_t Addr, const uint8_t *Src, size_t Size, bool Ephemeral, bool NoOverwrite) {
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (0x10000 - Addr));
+        copyChunk(Memory.data(), MemUsage, Blocks, Addr, Src, N, Ephemeral, NoOverwrite);
+        Addr = (uint16_t) (Addr + N);
+        Src += N;
+        Size -= N;
+    }
+}
+
+void PlainMemModel::fillSpan(uint16_t Addr, uint8_t Byte, size_t Size, bool Ephemeral, bool NoOverwrite) {
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (0x10000 - Addr));
+        fillChunk(Memory.data(), MemUsage, Blocks, Addr, Byte, N, Ephemeral, NoOverwrite);
+        Addr = (uint16_t) (Addr + N);
+        Size -= N;
+    }
+}
+
+void PlainMemModel::readSpan(uint8_t *Dest, uint16_t Addr, size_t Size) {
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (0x10000 - Addr));
+        std::memcpy(Dest, Memory.data() + Addr, N);
+        Addr = (uint16_t) (Addr + N);
+        Dest += N;
+        Size -= N;
+    }
+}
+
+void PlainMemModel::markUsed(uint16_t Addr, size_t Size) {
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (0x10000 - Addr));
+        Blocks.mark(Addr, N, false);
+        MemUsage.setRange(Addr, N);
+        Addr = (uint16_t) (Addr + N);
+        Size -= N;
+    }
+}
+
+const ZXMemModel::Page ZXMemModel::ZeroPage{};
+
+void ZXMemModel::writeSpan(uint16_t Addr, const uint8_t *Src, size_t Size, bool Ephemeral, bool NoOverwrite) {
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (PageSize - Addr % PageSize));
+        auto &P = pageForWrite(slotPage(Addr));
+        copyChunk(P.Data, P.Usage, P.Blocks, Addr % PageSize, Src, N, Ephemeral, NoOverwrite);
+        Addr = (uint16_t) (Addr + N);
+        Src += N;
+        Size -= N;
+    }
+}
+
+void ZXMemModel::fillSpan(uint16_t Addr, uint8_t Byte, size_t Size, bool Ephemeral, bool NoOverwrite) {
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (PageSize - Addr % PageSize));
+        auto &P = pageForWrite(slotPage(Addr));
+        fillChunk(P.Data, P.Usage, P.Blocks, Addr % PageSize, Byte, N, Ephemeral, NoOverwrite);
+        Addr = (uint16_t) (Addr + N);
+        Size -= N;
+    }
+}
+
+void ZXMemModel::readSpan(uint8_t *Dest, uint16_t Addr, size_t Size) {
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (PageSize - Addr % PageSize));
+        std::memcpy(Dest, pageForRead(slotPage(Addr)).Data + Addr % PageSize, N);
+        Addr = (uint16_t) (Addr + N);
+        Dest += N;
+        Size -= N;
+    }
+}
+
+void ZXMemModel::markUsed(uint16_t Addr, size_t Size) {
+    while (Size > 0) {
+        size_t N = std::min(Size, (size_t) (PageSize - Addr % PageSize));
+        auto &P = pageForWrite(slotPage(Addr));
+        P.Blocks.mark(Addr % PageSize, N, false);
+        P.Usage.setRange(Addr % PageSize, N);
+        Addr = (uint16_t) (Addr + N);
+        Size -= N;
+    }
+}
+
+ZXMemModel::ZXMemModel(const std::string &Name, int NPages) : MemModel(Name), Pages(NPages) {
     NumPages = NPages;
-    Memory.resize(PageSize * NPages, 0);
-    MemUsage.resize(PageSize * NPages, false);
 }
 
 optional<std::string> ZXMemModel::setPage(int Slot, int Page) {
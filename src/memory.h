@@ -9,17 +9,144 @@
 #include <map>
 #include <vector>
 #include <array>
-#include <bitset>
+#include <atomic>
+#include <memory>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <boost/optional.hpp>
 #include "errors.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 using namespace std::string_literals;
 using boost::optional;
 
+// Index of the lowest/highest set bit, Word must not be zero
+inline int lowestSetBit(uint64_t Word) {
+#if defined(_MSC_VER)
+    unsigned long Index;
+    _BitScanForward64(&Index, Word);
+    return (int) Index;
+#else
+    return __builtin_ctzll(Word);
+#endif
+}
+
+inline int highestSetBit(uint64_t Word) {
+#if defined(_MSC_VER)
+    unsigned long Index;
+    _BitScanReverse64(&Index, Word);
+    return (int) Index;
+#else
+    return 63 - __builtin_clzll(Word);
+#endif
+}
+
+// Memory usage map, one bit per byte packed into 64-bit words
+class UsageBitmap {
+private:
+    std::vector<uint64_t> Words;
+public:
+    explicit UsageBitmap(size_t NumBits) : Words((NumBits + 63) / 64, 0) { }
+
+    bool test(size_t i) const {
+        return (Words[i / 64] >> (i % 64)) & 1;
+    }
+
+    void set(size_t i) {
+        Words[i / 64] |= (uint64_t) 1 << (i % 64);
+    }
+
+    void setRange(size_t Start, size_t Size) {
+        while (Size > 0) {
+            auto Bit = Start % 64;
+            auto N = std::min(Size, (size_t) (64 - Bit));
+            auto Mask = N == 64 ? ~(uint64_t) 0 : (((uint64_t) 1 << N) - 1) << Bit;
+            Words[Start / 64] |= Mask;
+            Start += N;
+            Size -= N;
+        }
+    }
+
+    void clear() {
+        std::fill(Words.begin(), Words.end(), 0);
+    }
+
+    void clearWords(size_t First, size_t Count) {
+        std::fill(Words.begin() + First, Words.begin() + First + Count, 0);
+    }
+
+    uint64_t word(size_t i) const { return Words[i]; }
+
+    const uint64_t *words() const { return Words.data(); }
+};
+
+// Which 256-byte blocks of memory have been written to since the last clear
+// and which of them may hold ephemeral (written but unused) bytes
+class BlockSummary {
+private:
+    std::vector<uint64_t> Dirty;
+    std::vector<uint64_t> Ephemeral;
+
+    template<typename F>
+    static void forEachBit(const std::vector<uint64_t> &Bits, F Fn) {
+        for (size_t w = 0; w < Bits.size(); w++) {
+            for (uint64_t Word = Bits[w]; Word != 0; Word &= Word - 1) {
+                Fn(w * 64 + lowestSetBit(Word));
+            }
+        }
+    }
+
+public:
+    static constexpr size_t BlockSize = 256;
+
+    explicit BlockSummary(size_t NumBytes) :
+            Dirty((NumBytes / BlockSize + 63) / 64, 0), Ephemeral(Dirty.size(), 0) { }
+
+    void mark(size_t Start, size_t Size, bool IsEphemeral) {
+        for (size_t b = Start / BlockSize; b <= (Start + Size - 1) / BlockSize; b++) {
+            Dirty[b / 64] |= (uint64_t) 1 << (b % 64);
+            if (IsEphemeral)
+                Ephemeral[b / 64] |= (uint64_t) 1 << (b % 64);
+        }
+    }
+
+    template<typename F>
+    void forEachDirty(F Fn) const { forEachBit(Dirty, Fn); }
+
+    template<typename F>
+    void forEachEphemeral(F Fn) const { forEachBit(Ephemeral, Fn); }
+
+    void reset() {
+        std::fill(Dirty.begin(), Dirty.end(), 0);
+        resetEphemeral();
+    }
+
+    void resetEphemeral() {
+        std::fill(Ephemeral.begin(), Ephemeral.end(), 0);
+    }
+
+    bool hasEphemeral() const {
+        return std::any_of(Ephemeral.begin(), Ephemeral.end(), [](uint64_t W) { return W != 0; });
+    }
+};
+
+// Zero the unused bytes in blocks which got ephemeral writes
+void clearEphemeralBytes(uint8_t *Mem, const UsageBitmap &Usage, BlockSummary &Blocks);
+
+// Zero the memory and usage of all dirty blocks
+void clearDirtyBlocks(uint8_t *Mem, UsageBitmap &Usage, BlockSummary &Blocks);
+
 class MemModel {
 protected:
     std::string Name;
+
+    // Number of consecutive bytes from Addr (at most Max) whose usage equals Used,
+    // scanning up or down the address space a word of the usage map at a time
+    size_t runLength(uint16_t Addr, size_t Max, bool Used, bool Backwards);
 public:
     explicit MemModel(const std::string &name) : Name(name) { }
 
@@ -39,9 +166,23 @@ public:
 
     virtual void writeByte(uint16_t Addr, uint8_t Byte, bool Ephemeral, bool NoOvewrite) = 0;
 
+    // Bulk access to the memory visible in the 64K address space.
+    // The range is split at slot boundaries once and copied page by page,
+    // addresses wrap around at the end of the address space.
+    virtual void writeSpan(uint16_t Addr, const uint8_t *Src, size_t Size,
+                           bool Ephemeral = false, bool NoOverwrite = false) = 0;
+
+    virtual void fillSpan(uint16_t Addr, uint8_t Byte, size_t Size,
+                          bool Ephemeral = false, bool NoOverwrite = false) = 0;
+
+    virtual void readSpan(uint8_t *Dest, uint16_t Addr, size_t Size) = 0;
+
+    // Mark a range as used without writing to it
+    virtual void markUsed(uint16_t Addr, size_t Size) = 0;
+
     void writeWord(uint16_t Addr, uint16_t Word, bool Ephemeral, bool NoOverwrite) {
-        writeByte(Addr, (uint8_t) (Word & 0xff), Ephemeral, NoOverwrite);
-        writeByte((uint16_t) (Addr + 1), (uint8_t) (Word >> 8), Ephemeral, NoOverwrite);
+        const uint8_t Bytes[2] = {(uint8_t) (Word & 0xff), (uint8_t) (Word >> 8)};
+        writeSpan(Addr, Bytes, 2, Ephemeral, NoOverwrite);
     }
 
     virtual bool usedAddr(uint16_t Addr) = 0;
@@ -55,25 +196,26 @@ public:
     optional<uint16_t> findUnusedBlock(uint16_t Start, uint16_t Size,
             uint16_t SearchLimit = 0, bool Backwards = false);
 
+    // True if none of the Size bytes starting at Start is used
     bool isUnusedBlock(uint16_t Start, uint16_t Size) {
-        auto Res = findUnusedBlock(Start, Size, Size);
-        return Res ? true : false;
+        return runLength(Start, Size, false, false) == Size;
     }
 
+    // Usage bits of the 16K quarter of the address space visible at Chunk * 0x4000
+    static constexpr size_t UsageChunkWords = 0x4000 / 64;
+
+    virtual const uint64_t *getUsageChunk(int Chunk) = 0;
+
     virtual void clearEphemerals() = 0;
 
     void memCpy(off_t Offset, const uint8_t *Src, uint16_t Size, bool Ephemeral = false, bool NoOverwrite = false) {
         // Wrap around the destination address while copying
-        for (uint16_t i = 0; i < Size; i++) {
-            writeByte((uint16_t) (Offset + i), *(Src + i), Ephemeral, NoOverwrite);
-        }
+        writeSpan((uint16_t) Offset, Src, Size, Ephemeral, NoOverwrite);
     }
 
     void memSet(off_t Offset, uint8_t Byte, uint16_t Size, bool Ephemeral = false, bool NoOverwrite = false) {
         // Wrap around the destination address while setting
-        for (uint16_t i = 0; i < Size; i++) {
-            writeByte((uint16_t) (Offset + i), Byte, Ephemeral, NoOverwrite);
-        }
+        fillSpan((uint16_t) Offset, Byte, Size, Ephemeral, NoOverwrite);
     }
 
     // Return error string on error
@@ -85,28 +227,33 @@ public:
 
     virtual int getPageForAddress(uint16_t CurrentAddr) = 0;
 
-    // TODO: replace with safer version
-    virtual void getBytes(uint8_t *Dest, uint16_t Addr, uint16_t Size) = 0;
-
     virtual void getBytes(uint8_t *Dest, int Slot, uint16_t AddrInPage, uint16_t Size) = 0;
 
     virtual const uint8_t *getPtrToMem() = 0;
 
     virtual void clear() = 0;
 
+    // False if nothing has been written to the page since it was last cleared
+    virtual bool isPageTouched(int Page) = 0;
+
     virtual const uint8_t *getPtrToPage(int Page) = 0;
 
     virtual const uint8_t *getPtrToPageInSlot(int Slot) = 0;
+
+    // Read-only copy of the current contents and slot mapping, not affected
+    // by later writes to this model
+    virtual std::shared_ptr<MemModel> snapshot() = 0;
 };
 
 // Plain 64K without paging
 class PlainMemModel : public MemModel {
 private:
     std::array<uint8_t, 0x10000> Memory;
-    std::bitset<0x10000> MemUsage;
+    UsageBitmap MemUsage;
+    BlockSummary Blocks;
 public:
-    PlainMemModel() : MemModel{"PLAIN"s} {
-        clear();
+    PlainMemModel() : MemModel{"PLAIN"s}, MemUsage(0x10000), Blocks(0x10000) {
+        Memory.fill(0);
     }
 
     ~PlainMemModel() override = default;
@@ -139,11 +286,13 @@ public:
         return Memory[Addr];
     }
 
-    void getBytes(uint8_t *Dest, uint16_t Addr, uint16_t Size) override {
-        for (int i = 0; i < Size; i++) {
-            *(Dest + i) = Memory[Addr + i];
-        }
-    }
+    void writeSpan(uint16_t Addr, const uint8_t *Src, size_t Size, bool Ephemeral, bool NoOverwrite) override;
+
+    void fillSpan(uint16_t Addr, uint8_t Byte, size_t Size, bool Ephemeral, bool NoOverwrite) override;
+
+    void readSpan(uint8_t *Dest, uint16_t Addr, size_t Size) override;
+
+    void markUsed(uint16_t Addr, size_t Size) override;
 
     void getBytes(uint8_t *Dest, int Slot, uint16_t AddrInPage, uint16_t Size) override {
         Fatal("getBytes()"s, *(setPage(0, 0)));
@@ -154,10 +303,15 @@ public:
     }
 
     void clear() override {
-        Memory.fill(0);
-        MemUsage.reset();
+        clearDirtyBlocks(Memory.data(), MemUsage, Blocks);
+    }
+
+    const uint64_t *getUsageChunk(int Chunk) override {
+        return MemUsage.words() + Chunk * UsageChunkWords;
     }
 
+    bool isPageTouched(int Page) override { return true; }
+
     const uint8_t *getPtrToPage(int Page) override {
         Fatal("GetPtrToPage()"s, *(setPage(0, 0)));
     }
@@ -167,36 +321,67 @@ public:
     }
 
     void writeByte(uint16_t Addr, uint8_t Byte, bool Ephemeral, bool NoOvewrite) override {
-        if (NoOvewrite && MemUsage[Addr])
+        if (NoOvewrite && MemUsage.test(Addr))
             return;
         Memory[Addr] = Byte;
+        Blocks.mark(Addr, 1, Ephemeral);
         if (!Ephemeral)
-            MemUsage[Addr] = true;
+            MemUsage.set(Addr);
     }
 
     bool usedAddr(uint16_t Addr) override {
-        return MemUsage[Addr];
+        return MemUsage.test(Addr);
     }
 
     void clearEphemerals() override {
-        for (size_t i = 0; i < Memory.size(); i++) {
-            if (!MemUsage[i])
-                Memory[i] = 0;
-        }
+        clearEphemeralBytes(Memory.data(), MemUsage, Blocks);
+    }
+
+    std::shared_ptr<MemModel> snapshot() override {
+        return std::make_shared<PlainMemModel>(*this);
     }
 };
 
 // ZX Spectrum 128, 256, 512, 1024 with 4 slots of 16K each
+// Pages are allocated on the first write, untouched pages read as zeros
 class ZXMemModel : public MemModel {
 private:
-    const size_t PageSize = 0x4000;
+    static constexpr size_t PageSize = 0x4000;
     int NumPages;
     int NumSlots = 4;
     int SlotPages[4] = {0, 5, 2, 7};
-    std::vector<uint8_t> Memory;
-    std::vector<bool> MemUsage;
-    off_t addrToOffset(uint16_t Addr) {
-        return SlotPages[Addr / PageSize] * PageSize + (Addr % PageSize);
+
+    struct Page {
+        uint8_t Data[PageSize] = {};
+        UsageBitmap Usage{PageSize};
+        BlockSummary Blocks{PageSize};
+    };
+    // Pages are shared with snapshots until the next write to them
+    std::vector<std::shared_ptr<Page>> Pages;
+
+    // Shared contents of all untouched pages
+    static const Page ZeroPage;
+
+    const Page &pageForRead(int PageNum) {
+        return Pages[PageNum] ? *Pages[PageNum] : ZeroPage;
+    }
+
+    Page &pageForWrite(int PageNum) {
+        auto &P = Pages[PageNum];
+        if (!P) {
+            P = std::make_shared<Page>();
+        } else if (P.use_count() > 1) {
+            P = std::make_shared<Page>(*P);
+        } else {
+            // The last snapshot holding the page may have just released it
+            // on another thread
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *P;
+    }
+
+    int slotPage(uint16_t Addr) {
+        return SlotPages[Addr / PageSize];
     }
 
 public:
@@ -205,65 +390,84 @@ public:
     ~ZXMemModel() override = default;
 
     uint8_t readByte(uint16_t Addr) override {
-        return Memory[addrToOffset(Addr)];
+        return pageForRead(slotPage(Addr)).Data[Addr % PageSize];
     }
 
-    void getBytes(uint8_t *Dest, uint16_t Addr, uint16_t Size) override {
-        for (int i = 0; i < Size; i++) {
-            *(Dest + i) = readByte(Addr + i);
-        }
-    }
+    void writeSpan(uint16_t Addr, const uint8_t *Src, size_t Size, bool Ephemeral, bool NoOverwrite) override;
+
+    void fillSpan(uint16_t Addr, uint8_t Byte, size_t Size, bool Ephemeral, bool NoOverwrite) override;
+
+    void readSpan(uint8_t *Dest, uint16_t Addr, size_t Size) override;
+
+    void markUsed(uint16_t Addr, size_t Size) override;
 
     void getBytes(uint8_t *Dest, int Slot, uint16_t AddrInPage, uint16_t Size) override {
-        uint16_t addr = AddrInPage + Slot * PageSize;
-        for (int i = 0; i < Size; i++) {
-            *(Dest + i) = readByte(addr + i);
-        }
+        readSpan(Dest, (uint16_t) (AddrInPage + Slot * PageSize), Size);
     }
 
     const uint8_t *getPtrToMem() override {
-        return (const uint8_t *) Memory.data();
+        Fatal("getPtrToMem()"s, "The "s + Name + " memory model is paged"s);
     }
 
+    // Untouched pages stay unallocated
     void clear() override {
-        Memory.assign(Memory.size(), 0);
-        MemUsage.assign(MemUsage.size(), false);
+        for (auto &P : Pages) {
+            P.reset();
+        }
     }
 
-    const uint8_t *getPtrToPage(int Page) override {
-        return (const uint8_t *) Memory.data() + Page * PageSize;
+    const uint64_t *getUsageChunk(int Chunk) override {
+        return pageForRead(SlotPages[Chunk]).Usage.words();
+    }
+
+    bool isPageTouched(int PageNum) override {
+        return (bool) Pages[PageNum];
+    }
+
+    const uint8_t *getPtrToPage(int PageNum) override {
+        return pageForRead(PageNum).Data;
     }
 
     const uint8_t *getPtrToPageInSlot(int Slot) override {
-        return (const uint8_t *) Memory.data() + SlotPages[Slot] * PageSize;
+        return pageForRead(SlotPages[Slot]).Data;
     }
 
     void writeByte(uint16_t Addr, uint8_t Byte, bool Ephemeral, bool NoOvewrite) override {
-        auto i = addrToOffset(Addr);
-        if (NoOvewrite && MemUsage[i])
+        auto &P = pageForWrite(slotPage(Addr));
+        auto i = Addr % PageSize;
+        if (NoOvewrite && P.Usage.test(i))
             return;
-        Memory[i] = Byte;
+        P.Data[i] = Byte;
+        P.Blocks.mark(i, 1, Ephemeral);
         if (!Ephemeral)
-            MemUsage[i] = true;
+            P.Usage.set(i);
     }
 
     bool usedAddr(uint16_t Addr) override {
-        return MemUsage[addrToOffset(Addr)];
+        return pageForRead(slotPage(Addr)).Usage.test(Addr % PageSize);
     }
 
     void clearEphemerals() override {
-        for (size_t i = 0; i < Memory.size(); i++) {
-            if (!MemUsage[i])
-                Memory[i] = 0;
+        for (int i = 0; i < NumPages; i++) {
+            if (Pages[i] && Pages[i]->Blocks.hasEphemeral()) {
+                auto &P = pageForWrite(i);
+                clearEphemeralBytes(P.Data, P.Usage, P.Blocks);
+            }
         }
     }
 
-    void writeByteToPage(int Page, uint16_t Offset, uint8_t Byte) {
+    std::shared_ptr<MemModel> snapshot() override {
+        return std::make_shared<ZXMemModel>(*this);
+    }
+
+    void writeByteToPage(int PageNum, uint16_t Offset, uint8_t Byte) {
         if (Offset >= PageSize)
             Fatal("In-page offset "s + std::to_string(Offset)
                   + " does not fit in page of size "s + std::to_string(PageSize));
-        Memory[PageSize * Page + Offset] = Byte;
-        MemUsage[PageSize * Page + Offset] = true;
+        auto &P = pageForWrite(PageNum);
+        P.Data[Offset] = Byte;
+        P.Blocks.mark(Offset, 1, false);
+        P.Usage.set(Offset);
     }
 
     void memcpyToPage(int Page, off_t Offset, const uint8_t *Src, uint16_t Size) {
@@ -321,6 +525,13 @@ public:
 
     void setMemModel(const std::string &name);
 
+    // Clear all memory models which have been used so far
+    void clearAll() {
+        for (auto &kv : MemModels) {
+            kv.second->clear();
+        }
+    }
+
     MemModel &getMemModel() {
         return *CurrentMemModel;
     }
@@ -361,8 +572,8 @@ public:
         return CurrentMemModel->getPageForAddress(Addr);
     }
 
-    void getBytes(uint8_t *Dest, uint16_t Addr, uint16_t Size) {
-        CurrentMemModel->getBytes(Dest, Addr, Size);
+    void readSpan(uint8_t *Dest, uint16_t Addr, size_t Size) {
+        CurrentMemModel->readSpan(Dest, Addr, Size);
     }
 
     void getBytes(uint8_t *Dest, int Slot, uint16_t AddrInPage, uint16_t Size) {
@@ -388,6 +599,18 @@ public:
     void writeByte(uint16_t Addr, uint8_t Byte) {
         CurrentMemModel->writeByte(Addr, Byte, false, false);
     }
+
+    void writeSpan(uint16_t Addr, const uint8_t *Src, size_t Size) {
+        CurrentMemModel->writeSpan(Addr, Src, Size);
+    }
+
+    void fillSpan(uint16_t Addr, uint8_t Byte, size_t Size) {
+        CurrentMemModel->fillSpan(Addr, Byte, Size);
+    }
+
+    void markUsed(uint16_t Addr, size_t Size) {
+        CurrentMemModel->markUsed(Addr, Size);
+    }
 };
 
 #endif //SJASMPLUS_MEMORY_H
@@ -39,7 +39,10 @@ namespace options {
 const char HELP[] = "help";
 const char LSTLAB[] = "lstlab";
 const char SYM[] = "sym";
+const char SYM_BIN[] = "sym-bin";
 const char LST[] = "lst";
+const char LST_BIN[] = "lst-bin";
+const char SRCMAP[] = "srcmap";
 const char EXP[] = "exp";
 const char RAW[] = "raw";
 const char LABELS[] = "labels";
@@ -53,14 +56,24 @@ const char DIRBOL[] = "dirbol";
 const char INC[] = "inc";
 const char I[] = "I";
 const char I2[] = "i";
+const char D[] = "D";
 const char OUTPUT_DIR[] = "output-dir";
 const char TARGET[] = "target";
+const char DEFER_SAVES[] = "defer-saves";
+const char PACK_CACHE[] = "pack-cache";
+const char PROFILE[] = "profile";
+const char TARGETS[] = "targets";
+const char SERVER[] = "server";
+const char CLIENT[] = "client";
 
 enum class OPT {
     HELP,
     LSTLAB,
     SYM,
+    SYM_BIN,
     LST,
+    LST_BIN,
+    SRCMAP,
     EXP,
     LABELS,
     RAW,
@@ -71,15 +84,25 @@ enum class OPT {
     DOS866,
     DIRBOL,
     INC,
+    DEFINE,
     OUTPUT_DIR,
-    TARGET
+    TARGET,
+    DEFER_SAVES,
+    PACK_CACHE,
+    PROFILE,
+    TARGETS,
+    SERVER,
+    CLIENT
 };
 
 std::map<std::string, OPT> OptMap{
         {HELP,       OPT::HELP},
         {LSTLAB,     OPT::LSTLAB},
         {SYM,        OPT::SYM},
+        {SYM_BIN,    OPT::SYM_BIN},
         {LST,        OPT::LST},
+        {LST_BIN,    OPT::LST_BIN},
+        {SRCMAP,     OPT::SRCMAP},
         {EXP,        OPT::EXP},
         {LABELS,     OPT::LABELS},
         {RAW,        OPT::RAW},
@@ -93,8 +116,15 @@ std::map<std::string, OPT> OptMap{
         {INC,        OPT::INC},
         {I,          OPT::INC},
         {I2,         OPT::INC},
+        {D,          OPT::DEFINE},
         {OUTPUT_DIR, OPT::OUTPUT_DIR},
-        {TARGET,     OPT::TARGET}
+        {TARGET,     OPT::TARGET},
+        {DEFER_SAVES, OPT::DEFER_SAVES},
+        {PACK_CACHE, OPT::PACK_CACHE},
+        {PROFILE,    OPT::PROFILE},
+        {TARGETS,    OPT::TARGETS},
+        {SERVER,     OPT::SERVER},
+        {CLIENT,     OPT::CLIENT}
 };
 
 struct State {
@@ -196,11 +226,18 @@ void showHelp() {
     _COUT "  --" _CMDL HELP _CMDL "                   This help information" _ENDL;
     _COUT "  -i<path> or -I<path> or --" _CMDL INC _CMDL "=<path>" _ENDL;
     _COUT "                           Include path" _ENDL;
+    _COUT "  -" _CMDL D _CMDL "<name>[=<value>]       Define <name> as <value> (1 if omitted)" _ENDL;
     _COUT "  --" _CMDL LST _CMDL "                    Save listing to <sourcefile1>.lst" _ENDL;
     _COUT "  --" _CMDL LST _CMDL "[=<filename>]       Save listing to <filename>" _ENDL;
+    _COUT "  --" _CMDL LST_BIN _CMDL "[=<filename>]   Save binary listing to <filename> or <sourcefile1>.lstb" _ENDL;
+    _COUT "                             (render it with lstbin2lst)" _ENDL;
+    _COUT "  --" _CMDL SRCMAP _CMDL "[=<filename>]    Save address to source line map for debuggers" _ENDL;
+    _COUT "                             to <filename> or <sourcefile1>.srcmap" _ENDL;
     _COUT "  --" _CMDL LSTLAB _CMDL "                 List labels at the end of the listing file" _ENDL;
     _COUT "  --" _CMDL SYM _CMDL "                    Save symbols list to <sourcefile1>.sym" _ENDL;
     _COUT "  --" _CMDL SYM _CMDL "=<filename>         Save symbols list to <filename>" _ENDL;
+    _COUT "  --" _CMDL SYM_BIN _CMDL "[=<filename>]   Save symbols sorted by address and by name in binary" _ENDL;
+    _COUT "                             form to <filename> or <sourcefile1>.symb" _ENDL;
     _COUT "  --" _CMDL EXP _CMDL "=<filename>         Save exports to <filename> (see EXPORT pseudo-op)" _ENDL;
     _COUT "  --" _CMDL LABELS _CMDL "                 Save symbols(labels) list to <sourcefile1>.lab" _ENDL;
     _COUT "                             in format compatible with UnrealSpeccy emulator" _ENDL;
@@ -221,6 +258,29 @@ void showHelp() {
     _COUT "    * 'i8080' restricts available instructions to those compatible with i8080." _ENDL;
     _COUT "    * In both cases Z80 mnemonics are used." _ENDL;
     _COUT "  --" _CMDL DOS866 _CMDL "                 Convert from Windows CP1251 to DOS CP866 (Cyrillic)" _ENDL;
+    _COUT "  --" _CMDL DEFER_SAVES _CMDL "            Write files of SAVE* pseudo-ops in the background" _ENDL;
+    _COUT "                             (their messages follow the last pass)" _ENDL;
+    _COUT "  --" _CMDL PACK_CACHE _CMDL "[=<dir>]     Keep data packed by INCBIN and SAVEBIN between builds" _ENDL;
+    _COUT "                             in <dir> or <sourcefile1>.packcache" _ENDL;
+    _COUT "  --" _CMDL PROFILE _CMDL "[=<filename>]   Save time of passes, Lua blocks and Lua functions" _ENDL;
+    _COUT "                             to <filename> or <sourcefile1>.profile" _ENDL;
+    _COUT "  --" _CMDL TARGETS _CMDL "=<filename>     Assemble the targets listed in <filename> in parallel," _ENDL;
+    _COUT "                             one per line as <name>: <options> <sourcefile(s)>" _ENDL;
+    _COUT "  --" _CMDL SERVER _CMDL "=<socket>        Stay resident and assemble the requests of --client" _ENDL;
+    _COUT "                             through the Unix domain socket <socket>" _ENDL;
+    _COUT "  --" _CMDL CLIENT _CMDL "=<socket>        Let the server at <socket> assemble with the other" _ENDL;
+    _COUT "                             options (here if there is no server)" _ENDL;
+}
+
+std::vector<std::string> argsWithout(int argc, char *argv[], const std::string &Name) {
+    std::vector<std::string> Args;
+    for (int i = 1; i < argc; i++) {
+        std::string Arg{argv[i]};
+        if (Arg != "--"s + Name && Arg.compare(0, Name.size() + 3, "--"s + Name + "="s) != 0) {
+            Args.push_back(std::move(Arg));
+        }
+    }
+    return Args;
 }
 
 } // namespace options
@@ -242,18 +302,36 @@ COptions::COptions(int argc, char *argv[], std::vector<fs::path> &SrcFileNames)
                     case OPT::LSTLAB:
                         AddLabelListing = true;
                         break;
+                    case OPT::SRCMAP:
+                        if (!S.Value.empty()) {
+                            SourceMapFName = fs::path(S.Value);
+                        }
+                        SourceMapEnabled = true;
+                        break;
                     case OPT::SYM:
                         if (!S.Value.empty()) {
                             SymbolListFName = fs::path(S.Value);
                         }
                         SymbolListEnabled = true;
                         break;
+                    case OPT::SYM_BIN:
+                        if (!S.Value.empty()) {
+                            SymbolBinFName = fs::path(S.Value);
+                        }
+                        SymbolBinEnabled = true;
+                        break;
                     case OPT::LST:
                         if (!S.Value.empty()) {
                             ListingFName = fs::path(S.Value);
                         }
                         ListingEnabled = true;
                         break;
+                    case OPT::LST_BIN:
+                        if (!S.Value.empty()) {
+                            ListingBinFName = fs::path(S.Value);
+                        }
+                        ListingBinEnabled = true;
+                        break;
                     case OPT::EXP:
                         if (!S.Value.empty()) {
                             ExportFName = fs::path(S.Value);
@@ -291,6 +369,21 @@ COptions::COptions(int argc, char *argv[], std::vector<fs::path> &SrcFileNames)
                     case OPT::DIRBOL:
                         IsPseudoOpBOF = true;
                         break;
+                    case OPT::DEFER_SAVES:
+                        DeferSaves = true;
+                        break;
+                    case OPT::PACK_CACHE:
+                        if (!S.Value.empty()) {
+                            PackCacheDir = fs::path(S.Value);
+                        }
+                        PackCacheEnabled = true;
+                        break;
+                    case OPT::PROFILE:
+                        if (!S.Value.empty()) {
+                            ProfileFName = fs::path(S.Value);
+                        }
+                        ProfileEnabled = true;
+                        break;
                     case OPT::INC:
                         if (!S.Value.empty()) {
                             fs::path P{fs::absolute(S.Value)};
@@ -299,6 +392,36 @@ COptions::COptions(int argc, char *argv[], std::vector<fs::path> &SrcFileNames)
                             Fatal("No directory specified for -"s + (S.Name.size() == 1 ? ""s : "-"s) + S.Name);
                         }
                         break;
+                    case OPT::DEFINE:
+                        if (!S.Value.empty()) {
+                            auto Eq = S.Value.find('=');
+                            CmdLineDefines.emplace_back(S.Value.substr(0, Eq),
+                                                        Eq == std::string::npos ? "1"s : S.Value.substr(Eq + 1));
+                        } else {
+                            Fatal("No name specified for -"s + S.Name);
+                        }
+                        break;
+                    case OPT::TARGETS:
+                        if (!S.Value.empty()) {
+                            TargetsFName = fs::path(S.Value);
+                        } else {
+                            Fatal("No filename specified for --"s + S.Name);
+                        }
+                        break;
+                    case OPT::SERVER:
+                        if (!S.Value.empty()) {
+                            ServerSocket = fs::absolute(S.Value);
+                        } else {
+                            Fatal("No socket specified for --"s + S.Name);
+                        }
+                        break;
+                    case OPT::CLIENT:
+                        if (!S.Value.empty()) {
+                            ClientSocket = fs::absolute(S.Value);
+                        } else {
+                            Fatal("No socket specified for --"s + S.Name);
+                        }
+                        break;
                     case OPT::OUTPUT_DIR:
                         if (!S.Value.empty()) {
                             OutputDirectory = fs::absolute(S.Value);
@@ -342,10 +465,30 @@ COptions::COptions(int argc, char *argv[], std::vector<fs::path> &SrcFileNames)
             ListingFName = SrcFileNames[0];
             ListingFName.replace_extension(".lst");
         }
+        if (ListingBinEnabled && ListingBinFName.empty()) {
+            ListingBinFName = SrcFileNames[0];
+            ListingBinFName.replace_extension(".lstb");
+        }
+        if (SourceMapEnabled && SourceMapFName.empty()) {
+            SourceMapFName = SrcFileNames[0];
+            SourceMapFName.replace_extension(".srcmap");
+        }
+        if (PackCacheEnabled && PackCacheDir.empty()) {
+            PackCacheDir = SrcFileNames[0];
+            PackCacheDir.replace_extension(".packcache");
+        }
+        if (ProfileEnabled && ProfileFName.empty()) {
+            ProfileFName = SrcFileNames[0];
+            ProfileFName.replace_extension(".profile");
+        }
         if (SymbolListEnabled && SymbolListFName.empty()) {
             SymbolListFName = SrcFileNames[0];
             SymbolListFName.replace_extension(".sym");
         }
+        if (SymbolBinEnabled && SymbolBinFName.empty()) {
+            SymbolBinFName = SrcFileNames[0];
+            SymbolBinFName.replace_extension(".symb");
+        }
         if (LabelsListEnabled && LabelsListFName.empty()) {
             LabelsListFName = SrcFileNames[0];
             LabelsListFName.replace_extension(".lab");
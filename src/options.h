@@ -30,6 +30,9 @@
 #define SJASMPLUS_OPTIONS_H
 
 #include <list>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "fs.h"
 
@@ -44,6 +47,10 @@ enum class target {
 
 void showHelp();
 
+// The arguments after the program name without --<Name>[=<value>], for the
+// assemblies run by --targets and --client
+std::vector<std::string> argsWithout(int argc, char *argv[], const std::string &Name);
+
 } // namespace options
 
 class COptions {
@@ -53,8 +60,14 @@ public:
 
     bool SymbolListEnabled = false;
     fs::path SymbolListFName;
+    bool SymbolBinEnabled = false;
+    fs::path SymbolBinFName;
     bool ListingEnabled = false;
     fs::path ListingFName;
+    bool ListingBinEnabled = false;
+    fs::path ListingBinFName;
+    bool SourceMapEnabled = false;
+    fs::path SourceMapFName;
 
     fs::path ExportFName;
     fs::path RawOutputFileName;
@@ -71,9 +84,19 @@ public:
     bool FakeInstructions = true;
     bool EnableOrOverrideRawOutput = false;
     bool ConvertWindowsToDOS = false;
+    bool DeferSaves = false;
+    bool PackCacheEnabled = false;
+    fs::path PackCacheDir;
+    bool ProfileEnabled = false;
+    fs::path ProfileFName;
+    fs::path TargetsFName;
+    fs::path ServerSocket;
+    fs::path ClientSocket;
 
     std::list<fs::path> IncludeDirsList;
     std::list<fs::path> CmdLineIncludeDirsList;
+    // -D<name>[=<value>] in the order given
+    std::vector<std::pair<std::string, std::string>> CmdLineDefines;
 
     options::target Target = options::target::Z80;
 };
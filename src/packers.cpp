@@ -0,0 +1,364 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include "packers.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+struct Match {
+    int Offset;
+    int Length;
+};
+
+// Hash chains over the two bytes at each position, every earlier position is
+// a candidate. Data is at most a few dozen KB, so a deep search is cheap.
+class MatchFinder {
+private:
+    static const int MaxDepth = 256;
+
+    const std::string &Data;
+    std::vector<int> Head;
+    std::vector<int> Prev;
+    int Inserted = 0;
+
+    int key(int Pos) const {
+        return (uint8_t) Data[Pos] | (uint8_t) Data[Pos + 1] << 8;
+    }
+
+    void insertUpTo(int Pos) {
+        for (; Inserted < Pos && Inserted + 1 < (int) Data.size(); Inserted++) {
+            Prev[Inserted] = Head[key(Inserted)];
+            Head[key(Inserted)] = Inserted;
+        }
+    }
+
+public:
+    explicit MatchFinder(const std::string &_Data) : Data{_Data}, Head(0x10000, -1), Prev(_Data.size(), -1) {}
+
+    int matchLength(int Pos, int From, int MaxLength) const {
+        int Length = 0;
+        while (Length < MaxLength && Data[From + Length] == Data[Pos + Length]) {
+            Length++;
+        }
+        return Length;
+    }
+
+    // Longest match at Pos, the nearest one of equal matches
+    Match longest(int Pos, int MaxOffset, int MaxLength) {
+        Match Best{0, 0};
+        if (Pos + 1 >= (int) Data.size()) {
+            return Best;
+        }
+        insertUpTo(Pos);
+        int Depth = MaxDepth;
+        for (int From = Head[key(Pos)]; From >= 0 && Pos - From <= MaxOffset && Depth-- > 0; From = Prev[From]) {
+            if (From >= Pos) {
+                continue;
+            }
+            int Length = matchLength(Pos, From, MaxLength);
+            if (Length > Best.Length) {
+                Best = {Pos - From, Length};
+                if (Length == MaxLength) {
+                    break;
+                }
+            }
+        }
+        return Best;
+    }
+};
+
+// Bit stream of ZX0: bits are packed into bytes interleaved with the data
+// bytes, most significant bit first
+class ZX0Writer {
+private:
+    std::string Out;
+    size_t BitIndex = 0;
+    int BitMask = 0;
+    // The next bit goes into the low bit of the last byte. True at the start,
+    // as the indicator of the first literals is implied.
+    bool Backtrack = true;
+
+public:
+    void byte(uint8_t B) {
+        Out += (char) B;
+    }
+
+    void bit(bool V) {
+        if (Backtrack) {
+            if (V) {
+                Out.back() = (char) (Out.back() | 1);
+            }
+            Backtrack = false;
+            return;
+        }
+        if (BitMask == 0) {
+            BitMask = 0x80;
+            BitIndex = Out.size();
+            Out += '\0';
+        }
+        if (V) {
+            Out[BitIndex] = (char) (Out[BitIndex] | BitMask);
+        }
+        BitMask >>= 1;
+    }
+
+    // Interlaced Elias gamma code of V >= 1
+    void gamma(int V, bool Invert = false) {
+        int Top = 1;
+        while (Top * 2 <= V) {
+            Top *= 2;
+        }
+        for (int B = Top >> 1; B; B >>= 1) {
+            bit(false);
+            bit(((V & B) != 0) != Invert);
+        }
+        bit(true);
+    }
+
+    void backtrack() {
+        Backtrack = true;
+    }
+
+    std::string &data() { return Out; }
+};
+
+// Offset 0 for literals
+struct Token {
+    int Offset;
+    int Length;
+};
+
+std::vector<Token> parseZX0(const std::string &Data) {
+    const int MaxOffset = 32640;
+    const int Size = (int) Data.size();
+    MatchFinder Finder{Data};
+    std::vector<Token> Tokens{{0, 1}};
+    int Pos = 1, LastOffset = 1;
+
+    // A new offset costs at least a byte, so a far one needs a longer match
+    auto worthIt = [](const Match &M) {
+        return M.Length >= 2 && (M.Offset <= 128 || M.Length >= 3);
+    };
+
+    while (Pos < Size) {
+        auto M = Finder.longest(Pos, MaxOffset, Size - Pos);
+        // The last offset can only be repeated right after literals
+        if (Tokens.back().Offset == 0) {
+            int Rep = Finder.matchLength(Pos, Pos - LastOffset, Size - Pos);
+            if (Rep >= 2 && Rep + 1 >= M.Length) {
+                Tokens.push_back({LastOffset, Rep});
+                Pos += Rep;
+                continue;
+            }
+        }
+        if (worthIt(M)) {
+            // Lazy matching: a longer match at the next byte is worth a literal
+            auto Next = Finder.longest(Pos + 1, MaxOffset, Size - Pos - 1);
+            if (Next.Length <= M.Length + 1) {
+                Tokens.push_back({M.Offset, M.Length});
+                LastOffset = M.Offset;
+                Pos += M.Length;
+                continue;
+            }
+        }
+        if (Tokens.back().Offset != 0) {
+            Tokens.push_back({0, 0});
+        }
+        Tokens.back().Length++;
+        Pos++;
+    }
+    return Tokens;
+}
+
+std::string packZX0(const std::string &Data) {
+    ZX0Writer W;
+    int Pos = 0, LastOffset = 1;
+    bool AfterLiterals = false;
+    for (const auto &T : parseZX0(Data)) {
+        if (T.Offset == 0) {
+            W.bit(false);
+            W.gamma(T.Length);
+            for (int i = 0; i < T.Length; i++) {
+                W.byte((uint8_t) Data[Pos + i]);
+            }
+        } else if (AfterLiterals && T.Offset == LastOffset) {
+            W.bit(false);
+            W.gamma(T.Length);
+        } else {
+            W.bit(true);
+            W.gamma((T.Offset - 1) / 128 + 1, true);
+            W.byte((uint8_t) ((127 - (T.Offset - 1) % 128) << 1));
+            W.backtrack();
+            W.gamma(T.Length - 1);
+            LastOffset = T.Offset;
+        }
+        AfterLiterals = T.Offset == 0;
+        Pos += T.Length;
+    }
+    // End marker
+    W.bit(true);
+    W.gamma(256, true);
+    return std::move(W.data());
+}
+
+void putLZ4Length(std::string &Out, int Length) {
+    for (Length -= 15; Length >= 255; Length -= 255) {
+        Out += (char) 255;
+    }
+    Out += (char) Length;
+}
+
+// Literals followed by a match, or only literals if MatchLength is 0
+void putLZ4Sequence(std::string &Out, const std::string &Data, int Anchor, int Literals, int Offset,
+                    int MatchLength) {
+    int LitNibble = std::min(Literals, 15);
+    int MatchNibble = MatchLength ? std::min(MatchLength - 4, 15) : 0;
+    Out += (char) (LitNibble << 4 | MatchNibble);
+    if (Literals >= 15) {
+        putLZ4Length(Out, Literals);
+    }
+    Out.append(Data, Anchor, Literals);
+    if (MatchLength) {
+        Out += (char) (Offset & 0xff);
+        Out += (char) (Offset >> 8);
+        if (MatchLength - 4 >= 15) {
+            putLZ4Length(Out, MatchLength - 4);
+        }
+    }
+}
+
+std::string packLZ4(const std::string &Data) {
+    // The last match starts 12 bytes before the end at the latest, and the
+    // last 5 bytes are literals
+    const int MinMatch = 4, LastLiterals = 5, MatchStartLimit = 12;
+    const int Size = (int) Data.size();
+    MatchFinder Finder{Data};
+    std::string Out;
+    int Anchor = 0;
+    for (int Pos = 0; Pos + MatchStartLimit <= Size;) {
+        auto M = Finder.longest(Pos, 0xffff, Size - LastLiterals - Pos);
+        if (M.Length < MinMatch) {
+            Pos++;
+            continue;
+        }
+        putLZ4Sequence(Out, Data, Anchor, Pos - Anchor, M.Offset, M.Length);
+        Pos += M.Length;
+        Anchor = Pos;
+    }
+    putLZ4Sequence(Out, Data, Anchor, Size - Anchor, 0, 0);
+    return Out;
+}
+
+// FNV-1a
+uint64_t hash(const std::string &Data) {
+    uint64_t H = 0xcbf29ce484222325ULL;
+    for (char C : Data) {
+        H = (H ^ (uint8_t) C) * 0x100000001b3ULL;
+    }
+    return H;
+}
+
+} // namespace
+
+namespace packers {
+
+optional<Method> find(const std::string &Name) {
+    auto N = boost::algorithm::to_lower_copy(Name);
+    if (N == "zx0"s) {
+        return Method::ZX0;
+    } else if (N == "lz4"s) {
+        return Method::LZ4;
+    }
+    return boost::none;
+}
+
+const char *name(Method M) {
+    return M == Method::ZX0 ? "zx0" : "lz4";
+}
+
+optional<std::string> pack(Method M, const std::string &Data, std::string &Packed) {
+    if (Data.empty()) {
+        return "Nothing to pack"s;
+    }
+    Packed = M == Method::ZX0 ? packZX0(Data) : packLZ4(Data);
+    return boost::none;
+}
+
+} // namespace packers
+
+bool PackCache::load(const fs::path &Dir, const std::string &Key, std::string &Packed) {
+    fs::ifstream IFS(Dir / Key, std::ios::binary);
+    if (!IFS) {
+        return false;
+    }
+    Packed.assign(std::istreambuf_iterator<char>(IFS), std::istreambuf_iterator<char>());
+    return !IFS.bad();
+}
+
+void PackCache::store(const fs::path &Dir, const std::string &Key, const std::string &Packed) {
+    // The cache is only an optimization, so failures are ignored. A unique
+    // temporary file renamed into place keeps concurrent builds from
+    // reading a partial result.
+    boost::system::error_code EC;
+    fs::create_directories(Dir, EC);
+    fs::path TmpFileName = Dir / fs::unique_path(Key + ".%%%%%%%%.tmp"s);
+    {
+        fs::ofstream OFS(TmpFileName, std::ios::binary);
+        if (!OFS) {
+            return;
+        }
+        OFS.write(Packed.data(), Packed.size());
+        OFS.close();
+        if (!OFS) {
+            fs::remove(TmpFileName, EC);
+            return;
+        }
+    }
+    fs::rename(TmpFileName, Dir / Key, EC);
+    if (EC) {
+        fs::remove(TmpFileName, EC);
+    }
+}
+
+optional<std::string> PackCache::pack(const fs::path &Dir, packers::Method M, const std::string &Data,
+                                      std::string &Packed) {
+    char Hash[17];
+    std::snprintf(Hash, sizeof(Hash), "%016llx", (unsigned long long) hash(Data));
+    // Bump the version when a packer's output changes
+    std::string Key = packers::name(M) + "-1-"s + Hash + "-"s + std::to_string(Data.size());
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        auto It = Results.find(Key);
+        if (It != Results.end()) {
+            Packed = *It->second;
+            return boost::none;
+        }
+    }
+    if (Dir.empty() || !load(Dir, Key, Packed)) {
+        auto Err = packers::pack(M, Data, Packed);
+        if (Err) {
+            return Err;
+        }
+        if (!Dir.empty()) {
+            store(Dir, Key, Packed);
+        }
+    }
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Results.emplace(Key, std::make_shared<const std::string>(Packed)).second) {
+        Order.push_back(Key);
+        Bytes += Packed.size();
+        while (Bytes > MaxBytes && Order.size() > 1) {
+            auto Oldest = Results.find(Order.front());
+            Bytes -= Oldest->second->size();
+            Results.erase(Oldest);
+            Order.pop_front();
+        }
+    }
+    return boost::none;
+}
@@ -0,0 +1,65 @@
+#ifndef SJASMPLUS_PACKERS_H
+#define SJASMPLUS_PACKERS_H
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <boost/optional.hpp>
+
+#include "fs.h"
+
+using boost::optional;
+
+// Built-in packers for INCBIN and SAVEBIN:
+//
+//   zx0  ZX0 stream (forward, v2 format) for the standard dzx0 unpackers
+//   lz4  raw LZ4 block without the frame, for the usual Z80 LZ4 unpackers
+//
+// Neither searches for the optimal parse: zx0 takes the longest match unless
+// the next byte starts a longer one, lz4 always takes the longest match. The
+// output unpacks with the stock routines but may be a little larger than the
+// reference packers produce.
+namespace packers {
+
+enum class Method {
+    ZX0, LZ4
+};
+
+// Case-insensitive packer name
+optional<Method> find(const std::string &Name);
+
+const char *name(Method M);
+
+optional<std::string> pack(Method M, const std::string &Data, std::string &Packed);
+
+} // namespace packers
+
+// Packed data by method and content, so every pass and every directive packing
+// the same data packs it once. With a directory (--pack-cache) the results are
+// also kept there between builds, one file per result. The results in memory
+// are limited to MaxBytes, the oldest are dropped first, as a --server keeps
+// them for all its requests. Safe to use from the --defer-saves threads and
+// from the assemblies of --targets.
+class PackCache {
+private:
+    std::mutex Mutex;
+    std::map<std::string, std::shared_ptr<const std::string>> Results;
+    // Keys of Results, oldest first
+    std::deque<std::string> Order;
+    size_t Bytes = 0;
+
+    bool load(const fs::path &Dir, const std::string &Key, std::string &Packed);
+
+    void store(const fs::path &Dir, const std::string &Key, const std::string &Packed);
+
+public:
+    static const size_t MaxBytes = 64 << 20;
+
+    // Dir is empty to keep the results in memory only
+    optional<std::string> pack(const fs::path &Dir, packers::Method M, const std::string &Data,
+                               std::string &Packed);
+};
+
+#endif //SJASMPLUS_PACKERS_H
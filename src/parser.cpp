@@ -41,15 +41,15 @@ using boost::algorithm::to_upper_copy;
 
 #include "parser.h"
 
-bool synerr;
+thread_local bool synerr;
 
 // FIXME: errors.cpp
-extern Assembler *Asm;
+extern thread_local Assembler *Asm;
 
-char sline[LINEMAX2], sline2[LINEMAX2];
+thread_local char sline[LINEMAX2], sline2[LINEMAX2];
 
-aint comlin = 0;
-int substituteDepthCount = 0, comnxtlin;
+thread_local aint comlin = 0;
+thread_local int substituteDepthCount = 0, comnxtlin;
 char dirDEFl[] = "def", dirDEFu[] = "DEF"; /* added for ReplaceDefine */
 
 void initLegacyParser() {
@@ -970,11 +970,13 @@ void luaParseLine(char *str) {
         return;
     }
 
+    auto Start = Asm->Profile.start();
     STRCPY(line, LINEMAX, str);
     parseLineSafe(lp);
 
     STRCPY(line, LINEMAX, ml);
     free(ml);
+    Asm->Profile.addAssemblerCall("parse_line", Start);
 }
 
 void luaParseCode(char *str) {
@@ -986,11 +988,13 @@ void luaParseCode(char *str) {
         return;
     }
 
+    auto Start = Asm->Profile.start();
     STRCPY(line, LINEMAX, str);
     parseLineSafe(lp, false);
 
     STRCPY(line, LINEMAX, ml);
     free(ml);
+    Asm->Profile.addAssemblerCall("parse_code", Start);
 }
 
 //eof parser.cpp
@@ -32,9 +32,9 @@
 #include "defines.h"
 #include "asm.h"
 
-extern bool synerr;
+extern thread_local bool synerr;
 
-extern char sline[LINEMAX2], sline2[LINEMAX2];
+extern thread_local char sline[LINEMAX2], sline2[LINEMAX2];
 
 void initLegacyParser();
 
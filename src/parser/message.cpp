@@ -1,11 +1,9 @@
-#include <iostream>
 #include <cstdlib>
 
+#include "errors.h"
 #include "message.h"
 
 using namespace std::string_literals;
-using std::cerr;
-using std::endl;
 
 namespace parser {
 
@@ -26,12 +24,14 @@ std::string formatMsg(MsgType Type, const tao::pegtl::parse_error &E) {
 }
 
 void msg(MsgType Type, const tao::pegtl::parse_error &E) {
-    cerr << formatMsg(Type, E) << endl;
+    // Through the messages of the assembly, to reach a --client or the
+    // output of a --targets target
+    errorStream() << formatMsg(Type, E) << std::endl;
 }
 
 void fatal(const tao::pegtl::parse_error &E) {
     msg(MsgType::Error, E);
-    std::exit(EXIT_FAILURE);
+    throw AssemblyAborted{EXIT_FAILURE};
 }
 
 } // namespace parser
@@ -4,7 +4,7 @@
 
 #include "struct.h"
 
-extern std::string PreviousIsLabel;
+extern thread_local std::string PreviousIsLabel;
 
 void parseStructLabel(const char *&P, CStruct &St) {
     std::string L;
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "lua_support.h"
+#include "profiler.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+// Address of this is the registry key of the profiler of a Lua state
+const char RegistryKey = 0;
+
+// Chunks of LUA blocks are named "script <file>:<line>", see loadLuaChunk()
+std::string functionKey(const lua_Debug &Ar) {
+    std::string Name = Ar.name ? Ar.name : "?";
+    if (Ar.what[0] == 'C') {
+        return Name + " [C]"s;
+    }
+    std::string Source{Ar.source};
+    std::string Where;
+    if (Source.compare(0, 7, "script ") == 0) {
+        auto Colon = Source.rfind(':');
+        Where = Source.substr(7, Colon - 7) + ":"s +
+                std::to_string(std::atoi(Source.c_str() + Colon + 1) + Ar.linedefined);
+    } else if (Source[0] == '@') {
+        Where = Source.substr(1) + ":"s + std::to_string(Ar.linedefined);
+    } else {
+        Where = Ar.short_src + ":"s + std::to_string(Ar.linedefined);
+    }
+    return Name + " "s + Where;
+}
+
+double ms(Profiler::Clock::duration D) {
+    return std::chrono::duration<double, std::milli>(D).count();
+}
+
+template<typename Map>
+std::vector<typename Map::const_iterator> byTotal(const Map &M) {
+    std::vector<typename Map::const_iterator> Sorted;
+    for (auto It = M.begin(); It != M.end(); ++It) {
+        Sorted.push_back(It);
+    }
+    std::stable_sort(Sorted.begin(), Sorted.end(), [](const auto &A, const auto &B) {
+        return A->second.Total > B->second.Total;
+    });
+    return Sorted;
+}
+
+template<typename... Args>
+std::string format(const char *Format, Args... A) {
+    char Buf[64];
+    std::snprintf(Buf, sizeof(Buf), Format, A...);
+    return Buf;
+}
+
+// Name padded to a column, then the values
+void appendRow(std::string &Out, const std::string &Name, const std::string &Values) {
+    Out += Name;
+    Out += Name.size() < 42 ? std::string(42 - Name.size(), ' ') : " "s;
+    Out += Values;
+    Out += '\n';
+}
+
+} // namespace
+
+void Profiler::attach(lua_State *L) {
+    if (!isActive()) {
+        return;
+    }
+    lua_pushlightuserdata(L, (void *) &RegistryKey);
+    lua_pushlightuserdata(L, this);
+    lua_settable(L, LUA_REGISTRYINDEX);
+    lua_sethook(L, luaHook, LUA_MASKCALL | LUA_MASKRET, 0);
+}
+
+void Profiler::luaHook(lua_State *L, lua_Debug *Ar) {
+    lua_pushlightuserdata(L, (void *) &RegistryKey);
+    lua_gettable(L, LUA_REGISTRYINDEX);
+    auto *P = (Profiler *) lua_touserdata(L, -1);
+    lua_pop(L, 1);
+    if (P) {
+        P->luaEvent(L, Ar);
+    }
+}
+
+void Profiler::luaEvent(lua_State *L, lua_Debug *Ar) {
+    auto Now = Clock::now();
+    if (Ar->event == LUA_HOOKCALL) {
+        lua_getinfo(L, "Sn", Ar);
+        Stack.push_back({Ar->what[0] == 'm' ? ""s : functionKey(*Ar), Now});
+        return;
+    }
+    // A return, or the end of a tail call which had replaced its caller
+    if (Stack.empty()) {
+        return;
+    }
+    auto F = std::move(Stack.back());
+    Stack.pop_back();
+    auto Elapsed = Now - F.Start;
+    if (!F.Key.empty()) {
+        auto &S = Functions[F.Key];
+        S.Calls++;
+        S.Total += Elapsed;
+        S.Self += Elapsed - F.Children;
+    }
+    if (!Stack.empty()) {
+        Stack.back().Children += Elapsed;
+    }
+}
+
+void Profiler::addPass(int Pass, Clock::time_point Start) {
+    if (isActive()) {
+        Passes.emplace_back(Pass, Clock::now() - Start);
+    }
+}
+
+void Profiler::beginLuaBlock(const std::string &Position) {
+    if (isActive()) {
+        BlockStack.push_back({Position, Clock::now(), Stack.size()});
+    }
+}
+
+void Profiler::endLuaBlock() {
+    if (!isActive() || BlockStack.empty()) {
+        return;
+    }
+    auto B = std::move(BlockStack.back());
+    BlockStack.pop_back();
+    auto &S = Blocks[B.Position];
+    S.Calls++;
+    S.Total += Clock::now() - B.Start;
+    // Frames left by a Lua error in the block never got their return, the
+    // frames of the blocks and functions running it stay
+    if (Stack.size() > B.Depth) {
+        Stack.resize(B.Depth);
+    }
+}
+
+void Profiler::addAssemblerCall(const char *Name, Clock::time_point Start) {
+    if (isActive()) {
+        auto &S = AssemblerCalls[Name];
+        S.Calls++;
+        S.Total += Clock::now() - Start;
+    }
+}
+
+optional<std::string> Profiler::write() const {
+    fs::ofstream OFS(FileName);
+    if (!OFS) {
+        return "Error opening file: "s + FileName.string();
+    }
+    std::string Out;
+    Clock::duration Total{};
+    appendRow(Out, "Passes"s, format("%18s", "ms"));
+    for (const auto &P : Passes) {
+        appendRow(Out, "  pass "s + std::to_string(P.first), format("%18.3f", ms(P.second)));
+        Total += P.second;
+    }
+    appendRow(Out, "  total"s, format("%18.3f", ms(Total)));
+
+    Out += '\n';
+    appendRow(Out, "LUA blocks"s, format("%6s%12s", "calls", "ms"));
+    for (const auto &It : byTotal(Blocks)) {
+        appendRow(Out, "  "s + It->first, format("%6llu%12.3f", (unsigned long long) It->second.Calls,
+                                                ms(It->second.Total)));
+    }
+
+    Out += '\n';
+    appendRow(Out, "Lua functions"s, format("%6s%12s%12s", "calls", "ms", "self ms"));
+    for (const auto &It : byTotal(Functions)) {
+        appendRow(Out, "  "s + It->first, format("%6llu%12.3f%12.3f", (unsigned long long) It->second.Calls,
+                                                ms(It->second.Total), ms(It->second.Self)));
+    }
+
+    Out += '\n';
+    appendRow(Out, "Assembler calls from Lua"s, format("%6s%12s", "calls", "ms"));
+    for (const auto &It : byTotal(AssemblerCalls)) {
+        appendRow(Out, "  "s + It->first, format("%6llu%12.3f", (unsigned long long) It->second.Calls,
+                                                ms(It->second.Total)));
+    }
+
+    OFS << Out;
+    OFS.close();
+    if (!OFS) {
+        return "Error writing file: "s + FileName.string();
+    }
+    return boost::none;
+}
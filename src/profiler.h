@@ -0,0 +1,87 @@
+#ifndef SJASMPLUS_PROFILER_H
+#define SJASMPLUS_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "fs.h"
+
+using boost::optional;
+
+struct lua_State;
+struct lua_Debug;
+
+// Time report of the assembly (--profile): time of each pass and, for Lua,
+// time and calls of each LUA and INCLUDELUA block, of each Lua function
+// (through call and return hooks, with the time spent in the functions it
+// calls left out of its self time) and of the calls back into the assembler
+// with sj.parse_line and sj.parse_code.
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct Stat {
+        uint64_t Calls = 0;
+        Clock::duration Total{};
+        Clock::duration Self{};
+    };
+
+    struct Frame {
+        // Empty for the main chunks, they are accounted as blocks
+        std::string Key;
+        Clock::time_point Start;
+        Clock::duration Children{};
+    };
+
+    // A LUA block can run another one, e.g. through sj.parse_line of a macro
+    // with a LUA block
+    struct BlockFrame {
+        std::string Position;
+        Clock::time_point Start;
+        // Size of Stack when the block started
+        size_t Depth;
+    };
+
+    fs::path FileName;
+    std::vector<std::pair<int, Clock::duration>> Passes;
+    std::map<std::string, Stat> Blocks, Functions, AssemblerCalls;
+    std::vector<Frame> Stack;
+    std::vector<BlockFrame> BlockStack;
+
+    static void luaHook(lua_State *L, lua_Debug *Ar);
+
+    void luaEvent(lua_State *L, lua_Debug *Ar);
+
+public:
+    void init(const fs::path &_FileName) {
+        FileName = _FileName;
+    }
+
+    bool isActive() const { return !FileName.empty(); }
+
+    // Install the Lua hooks, if active
+    void attach(lua_State *L);
+
+    Clock::time_point start() const {
+        return isActive() ? Clock::now() : Clock::time_point{};
+    }
+
+    void addPass(int Pass, Clock::time_point Start);
+
+    // Position is file:line of a LUA block or the file of INCLUDELUA
+    void beginLuaBlock(const std::string &Position);
+
+    void endLuaBlock();
+
+    // sj.parse_line, sj.parse_code and their short names
+    void addAssemblerCall(const char *Name, Clock::time_point Start);
+
+    optional<std::string> write() const;
+};
+
+#endif //SJASMPLUS_PROFILER_H
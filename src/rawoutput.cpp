@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cstring>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "rawoutput.h"
+
+void RawOutput::open(const fs::path &FileName, std::ios_base::openmode Mode) {
+    close();
+    OFS.open(FileName, Mode);
+}
+
+bool RawOutput::openMapped(const fs::path &FileName, std::ios_base::openmode Mode, uintmax_t Size) {
+#ifndef WIN32
+    close();
+    if (Size == 0 || Size > SIZE_MAX)
+        return false;
+    // Like the stream, only create the file when truncating
+    int Flags = O_RDWR;
+    if (Mode & std::ios_base::trunc)
+        Flags |= O_CREAT | O_TRUNC;
+    int F = ::open(FileName.c_str(), Flags, 0666);
+    if (F < 0)
+        return false;
+    struct stat St;
+    if (fstat(F, &St) != 0
+        || (St.st_size < (off_t) Size && ftruncate(F, (off_t) Size) != 0)) {
+        ::close(F);
+        return false;
+    }
+    void *M = mmap(nullptr, (size_t) Size, PROT_READ | PROT_WRITE, MAP_SHARED, F, 0);
+    if (M == MAP_FAILED) {
+        // Undo the extension. Should that fail, the stream written instead
+        // is resized to SIZE when it is closed anyway (enforceFileSize())
+        if (ftruncate(F, St.st_size) != 0) {
+            St.st_size = (off_t) Size;
+        }
+        ::close(F);
+        return false;
+    }
+    Fd = F;
+    Map = static_cast<uint8_t *>(M);
+    MapSize = (size_t) Size;
+    InitialSize = HighWater = St.st_size;
+    Pos = (Mode & std::ios_base::ate) ? InitialSize : 0;
+    Failed = false;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RawOutput::closeMapped() {
+#ifndef WIN32
+    bool Ok = munmap(Map, MapSize) == 0;
+    // Leave the file with the size the stream would have produced
+    Ok = ftruncate(Fd, std::max(InitialSize, HighWater)) == 0 && Ok;
+    Ok = ::close(Fd) == 0 && Ok;
+    Map = nullptr;
+    Fd = -1;
+    return Ok;
+#else
+    return true;
+#endif
+}
+
+void RawOutput::write(const char *Data, size_t Size) {
+    if (Map != nullptr) {
+        if (!Failed) {
+            if ((uintmax_t) Pos < MapSize)
+                std::memcpy(Map + Pos, Data, std::min(Size, (size_t) (MapSize - Pos)));
+            advance(Size);
+        }
+        return;
+    }
+    if (Buffer.size() + Size > BufferSize) {
+        flush();
+        // Large blocks bypass the buffer
+        if (Size >= BufferSize) {
+            OFS.write(Data, Size);
+            return;
+        }
+    }
+    Buffer.insert(Buffer.end(), Data, Data + Size);
+}
+
+void RawOutput::fill(char Byte, size_t Size) {
+    if (Map != nullptr) {
+        if (!Failed) {
+            if ((uintmax_t) Pos < MapSize)
+                std::memset(Map + Pos, Byte, std::min(Size, (size_t) (MapSize - Pos)));
+            advance(Size);
+        }
+        return;
+    }
+    while (Size > 0) {
+        if (Buffer.size() == BufferSize)
+            flush();
+        auto N = std::min(Size, BufferSize - Buffer.size());
+        Buffer.insert(Buffer.end(), N, Byte);
+        Size -= N;
+    }
+}
+
+void RawOutput::flush() {
+    if (!Buffer.empty()) {
+        OFS.write(Buffer.data(), Buffer.size());
+        Buffer.clear();
+    }
+}
+
+bool RawOutput::close() {
+    if (Map != nullptr) {
+        return closeMapped();
+    } else if (OFS.is_open()) {
+        flush();
+        // Not failbit, a failed seek is reported by the seek
+        bool Ok = !OFS.bad();
+        return OFS.rdbuf()->close() != nullptr && Ok;
+    }
+    return true;
+}
+
+std::streampos RawOutput::tell() {
+    if (Map != nullptr) {
+        return Failed ? std::streampos(-1) : std::streampos(Pos);
+    }
+    flush();
+    return OFS.tellp();
+}
+
+void RawOutput::seek(std::streamoff Offset, std::ios_base::seekdir Method) {
+    if (Map != nullptr) {
+        if (Failed)
+            return;
+        std::streamoff NewPos = Offset;
+        if (Method == std::ios_base::cur) {
+            NewPos += Pos;
+        } else if (Method == std::ios_base::end) {
+            NewPos += std::max(InitialSize, HighWater);
+        }
+        if (NewPos < 0) {
+            Failed = true;
+        } else {
+            Pos = NewPos;
+        }
+        return;
+    }
+    flush();
+    OFS.seekp(Offset, Method);
+}
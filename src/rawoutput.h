@@ -0,0 +1,86 @@
+#ifndef SJASMPLUS_RAWOUTPUT_H
+#define SJASMPLUS_RAWOUTPUT_H
+
+#include <vector>
+#include <cstdint>
+#include "fs.h"
+
+// Raw output file with a write buffer in front of it.
+// Contiguous writes are collected and written out in large blocks,
+// any positioning flushes the buffer first.
+//
+// When the final file size is known in advance (SIZE directive) the file
+// can instead be written through a memory mapping of that size. Writes
+// beyond the mapping are dropped as they would be truncated anyway.
+// The stream's failure semantics are kept: after a failed seek all
+// writes are ignored and tell() returns -1.
+class RawOutput {
+private:
+    fs::fstream OFS;
+    std::vector<char> Buffer;
+
+    // Memory mapped mode
+    int Fd = -1;
+    uint8_t *Map = nullptr;
+    size_t MapSize = 0;
+    std::streamoff Pos = 0;
+    std::streamoff HighWater = 0;
+    std::streamoff InitialSize = 0;
+    bool Failed = false;
+
+    void advance(size_t Size) {
+        Pos += Size;
+        if (Pos > HighWater)
+            HighWater = Pos;
+    }
+
+    bool closeMapped();
+
+public:
+    static const size_t BufferSize = 0x10000;
+
+    RawOutput() {
+        Buffer.reserve(BufferSize);
+    }
+
+    ~RawOutput() {
+        close();
+    }
+
+    void open(const fs::path &FileName, std::ios_base::openmode Mode);
+
+    // Returns false if the file could not be mapped, nothing is opened then
+    bool openMapped(const fs::path &FileName, std::ios_base::openmode Mode, uintmax_t Size);
+
+    bool isOpen() { return Map != nullptr || OFS.is_open(); }
+
+    void put(char Byte) {
+        if (Map != nullptr) {
+            if (!Failed) {
+                if ((uintmax_t) Pos < MapSize)
+                    Map[Pos] = (uint8_t) Byte;
+                advance(1);
+            }
+            return;
+        }
+        if (Buffer.size() == BufferSize)
+            flush();
+        Buffer.push_back(Byte);
+    }
+
+    void write(const char *Data, size_t Size);
+
+    void fill(char Byte, size_t Size);
+
+    void flush();
+
+    // False if the file could not be written completely
+    bool close();
+
+    std::streampos tell();
+
+    // Same semantics as std::ostream::seekp()
+    void seek(std::streamoff Offset, std::ios_base::seekdir Method);
+};
+
+#endif //SJASMPLUS_RAWOUTPUT_H
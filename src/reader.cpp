@@ -130,7 +130,7 @@ bool comma(const char *&P) {
     return true;
 }
 
-int cpc = '4';
+thread_local int cpc = '4';
 
 /* not modified */
 bool oParen(const char *&P, char C) {
@@ -0,0 +1,73 @@
+#include "global.h"
+#include "saves.h"
+#include "util.h"
+
+// FIXME: errors.cpp
+extern thread_local Assembler *Asm;
+
+void DeferredSaves::start(Job *J, const fs::path &FileName) {
+    Pool->submit([this, J, FileName] {
+        Asm = J->Owner;
+        captureDiagnostics(&J->Messages);
+        try {
+            J->Save();
+        } catch (const FatalDiagnostic &) {
+        }
+        captureDiagnostics(nullptr);
+        Asm = nullptr;
+        // Release the snapshot before the next job starts
+        J->Save = nullptr;
+
+        std::lock_guard<std::mutex> Lock(Mutex);
+        auto It = Pending.find(FileName);
+        It->second.pop_front();
+        if (It->second.empty()) {
+            Pending.erase(It);
+        } else {
+            start(It->second.front(), FileName);
+        }
+        Unfinished--;
+        JobDone.notify_all();
+    });
+}
+
+void DeferredSaves::add(const fs::path &FileName, std::function<void()> Save) {
+    Jobs.emplace_back(new Job{std::move(Save), Asm, getCurrentSrcFileNameForMsg(), (int) CurrentLocalLine, {}});
+    auto *J = Jobs.back().get();
+    auto Key = fileKey(FileName);
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Unfinished++;
+    auto &Queue = Pending[Key];
+    Queue.push_back(J);
+    if (Queue.size() == 1) {
+        start(J, Key);
+    }
+}
+
+void DeferredSaves::waitAll() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    JobDone.wait(Lock, [this] { return Unfinished == 0; });
+}
+
+void DeferredSaves::finish() {
+    waitAll();
+    if (Jobs.empty()) {
+        return;
+    }
+    const fs::path SrcFileName = getCurrentSrcFileNameForMsg();
+    const aint Line = CurrentLocalLine;
+    for (const auto &J : Jobs) {
+        setCurrentSrcFileNameForMsg(J->SrcFileName);
+        CurrentLocalLine = J->Line;
+        for (const auto &D : J->Messages) {
+            if (D.IsError) {
+                Error(D.Message, D.Detail, D.Type);
+            } else {
+                Warning(D.Message, D.Detail, D.Type);
+            }
+        }
+    }
+    Jobs.clear();
+    setCurrentSrcFileNameForMsg(SrcFileName);
+    CurrentLocalLine = Line;
+}
@@ -0,0 +1,63 @@
+#ifndef SJASMPLUS_SAVES_H
+#define SJASMPLUS_SAVES_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "fs.h"
+#include "errors.h"
+#include "threadpool.h"
+
+class Assembler;
+
+// SAVE* directives queued with --defer-saves. Each job owns a snapshot of the
+// memory taken at the directive, so the file is written on a worker thread
+// while assembling goes on. Jobs writing the same file run in the order they
+// were added, with the assembler of the thread which added them. Their errors
+// and warnings are reported by finish(), in the same order and with the source
+// line of the directive.
+class DeferredSaves {
+private:
+    struct Job {
+        std::function<void()> Save;
+        Assembler *Owner;
+        fs::path SrcFileName;
+        int Line;
+        std::vector<Diagnostic> Messages;
+    };
+
+    std::unique_ptr<ThreadPool> Pool;
+    // In the order of the directives
+    std::vector<std::unique_ptr<Job>> Jobs;
+    // Jobs not finished yet for each file (by its normalized absolute path),
+    // the first one is running
+    std::map<fs::path, std::deque<Job *>> Pending;
+    size_t Unfinished = 0;
+    std::mutex Mutex;
+    std::condition_variable JobDone;
+
+    void start(Job *J, const fs::path &FileName);
+
+public:
+    void enable(unsigned NumThreads) {
+        Pool.reset(new ThreadPool{NumThreads});
+    }
+
+    bool isEnabled() const { return (bool) Pool; }
+
+    // Save should only use its own snapshot of the memory
+    void add(const fs::path &FileName, std::function<void()> Save);
+
+    // Block until all queued files are written, e.g. before reading files back
+    void waitAll();
+
+    // Wait for all jobs and report their messages
+    void finish();
+};
+
+#endif //SJASMPLUS_SAVES_H
@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "asm.h"
+#include "errors.h"
+#include "lebytes.h"
+#include "server.h"
+
+using namespace std::string_literals;
+
+#ifndef WIN32
+
+namespace {
+
+volatile std::sig_atomic_t Stopping = 0;
+
+void stop(int) {
+    Stopping = 1;
+}
+
+bool writeAll(int Fd, const char *Data, size_t Size) {
+    while (Size > 0) {
+        auto N = ::write(Fd, Data, Size);
+        if (N < 0 && errno == EINTR) {
+            continue;
+        }
+        if (N <= 0) {
+            return false;
+        }
+        Data += N;
+        Size -= (size_t) N;
+    }
+    return true;
+}
+
+bool readAll(int Fd, char *Data, size_t Size) {
+    while (Size > 0) {
+        auto N = ::read(Fd, Data, Size);
+        if (N < 0 && errno == EINTR) {
+            continue;
+        }
+        if (N <= 0) {
+            return false;
+        }
+        Data += N;
+        Size -= (size_t) N;
+    }
+    return true;
+}
+
+bool writeFrame(int Fd, char Kind, const std::string &Data) {
+    std::string Header{Kind};
+    put32(Header, (uint32_t) Data.size());
+    return writeAll(Fd, Header.data(), Header.size()) && writeAll(Fd, Data.data(), Data.size());
+}
+
+bool readFrame(int Fd, char &Kind, std::string &Data) {
+    char Header[5];
+    if (!readAll(Fd, Header, sizeof(Header))) {
+        return false;
+    }
+    Kind = Header[0];
+    Data.resize(get32(Header + 1));
+    return Data.empty() || readAll(Fd, &Data[0], Data.size());
+}
+
+// Longer strings are not a request of the client
+const uint32_t MaxString = 1 << 20;
+const uint32_t MaxStrings = 1 << 16;
+
+bool readStrings(int Fd, std::vector<std::string> &Strings) {
+    char Buf[4];
+    if (!readAll(Fd, Buf, sizeof(Buf)) || get32(Buf) > MaxStrings) {
+        return false;
+    }
+    Strings.resize(get32(Buf));
+    for (auto &S : Strings) {
+        if (!readAll(Fd, Buf, sizeof(Buf)) || get32(Buf) > MaxString) {
+            return false;
+        }
+        S.resize(get32(Buf));
+        if (!S.empty() && !readAll(Fd, &S[0], S.size())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeStrings(std::string &Out, const std::vector<std::string> &Strings) {
+    put32(Out, (uint32_t) Strings.size());
+    for (const auto &S : Strings) {
+        put32(Out, (uint32_t) S.size());
+        Out += S;
+    }
+}
+
+// Sends what is written to it as frames of Kind, a line at a time as the
+// messages end with endl
+class FrameBuf : public std::streambuf {
+private:
+    int Fd;
+    char Kind;
+    std::string Pending;
+
+protected:
+    int_type overflow(int_type C) override {
+        if (C != traits_type::eof()) {
+            Pending += traits_type::to_char_type(C);
+            if (Pending.size() >= 4096) {
+                sync();
+            }
+        }
+        return traits_type::not_eof(C);
+    }
+
+    std::streamsize xsputn(const char *S, std::streamsize N) override {
+        Pending.append(S, (size_t) N);
+        return N;
+    }
+
+    int sync() override {
+        // A client which went away does not stop the assembly
+        if (!Pending.empty() && Fd >= 0 && !writeFrame(Fd, Kind, Pending)) {
+            Fd = -1;
+        }
+        Pending.clear();
+        return 0;
+    }
+
+public:
+    FrameBuf(int _Fd, char _Kind) : Fd{_Fd}, Kind{_Kind} {}
+};
+
+bool makeAddress(const fs::path &SocketName, sockaddr_un &Address) {
+    std::memset(&Address, 0, sizeof(Address));
+    Address.sun_family = AF_UNIX;
+    if (SocketName.string().size() >= sizeof(Address.sun_path)) {
+        return false;
+    }
+    std::strcpy(Address.sun_path, SocketName.c_str());
+    return true;
+}
+
+int connectTo(const sockaddr_un &Address) {
+    int Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (Fd >= 0 && connect(Fd, (const sockaddr *) &Address, sizeof(Address)) != 0) {
+        ::close(Fd);
+        return -1;
+    }
+    return Fd;
+}
+
+// Only the user running the server may use it, as it reads and writes files
+// with the rights of that user
+bool isOwnUser(int Fd) {
+#ifdef SO_PEERCRED
+    ucred Cred;
+    socklen_t Size = sizeof(Cred);
+    return getsockopt(Fd, SOL_SOCKET, SO_PEERCRED, &Cred, &Size) == 0 && Cred.uid == geteuid();
+#else
+    uid_t Uid;
+    gid_t Gid;
+    return getpeereid(Fd, &Uid, &Gid) == 0 && Uid == geteuid();
+#endif
+}
+
+// A client which stops sending its request or reading the answer does not
+// hold up the server
+const int TimeoutSeconds = 5;
+
+void setTimeouts(int Fd) {
+    timeval Timeout{TimeoutSeconds, 0};
+    setsockopt(Fd, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+    setsockopt(Fd, SOL_SOCKET, SO_SNDTIMEO, &Timeout, sizeof(Timeout));
+}
+
+int assemble(std::vector<std::string> &Args, std::shared_ptr<AssemblerCaches> &Caches) {
+    std::vector<char *> Argv;
+    for (auto &A : Args) {
+        Argv.push_back(&A[0]);
+    }
+    Argv.push_back(nullptr);
+    int RetValue = EXIT_FAILURE;
+    try {
+        Assembler A((int) Args.size(), Argv.data(), RetValue, Caches);
+    } catch (AssemblyAborted &E) {
+        // Thrown before the assembler could catch it, by the options
+        RetValue = E.ExitCode;
+    }
+    return RetValue;
+}
+
+void serve(int Fd, const fs::path &ServerDirectory, std::shared_ptr<AssemblerCaches> &Caches) {
+    std::vector<std::string> Request;
+    if (!readStrings(Fd, Request) || Request.empty()) {
+        return;
+    }
+    FrameBuf MessagesBuf{Fd, 'O'}, ErrorsBuf{Fd, 'E'};
+    std::ostream Messages{&MessagesBuf}, Errors{&ErrorsBuf};
+    redirectMessages(&Messages, &Errors);
+
+    std::vector<std::string> Args{"sjasmplus"s};
+    Args.insert(Args.end(), Request.begin() + 1, Request.end());
+    int RetValue = EXIT_FAILURE;
+    boost::system::error_code EC;
+    fs::current_path(Request[0], EC);
+    if (EC) {
+        Errors << "error: Cannot change to directory " << Request[0] << ": " << EC.message() << std::endl;
+    } else if (std::any_of(Args.begin() + 1, Args.end(), [](const std::string &A) {
+        return A.compare(0, 8, "--server") == 0 || A.compare(0, 8, "--client") == 0;
+    })) {
+        Errors << "error: --server and --client are not accepted by the server" << std::endl;
+    } else {
+        // The files may have moved between the include directories since
+        Caches->Files.clearResolved();
+        RetValue = assemble(Args, Caches);
+    }
+    fs::current_path(ServerDirectory, EC);
+
+    Messages.flush();
+    Errors.flush();
+    redirectMessages(nullptr);
+    std::string Exit;
+    put32(Exit, (uint32_t) RetValue);
+    writeFrame(Fd, 'X', Exit);
+}
+
+} // namespace
+
+int runServer(const fs::path &SocketName, std::shared_ptr<AssemblerCaches> Caches) {
+    sockaddr_un Address;
+    if (!makeAddress(SocketName, Address)) {
+        errorStream() << "error: Socket name too long: " << SocketName.string() << std::endl;
+        return EXIT_FAILURE;
+    }
+    // A socket left by a server which did not stop cleanly
+    int Other = connectTo(Address);
+    if (Other >= 0) {
+        ::close(Other);
+        errorStream() << "error: A server is already running at " << SocketName.string() << std::endl;
+        return EXIT_FAILURE;
+    }
+    unlink(Address.sun_path);
+
+    // The socket is created with the permissions 0600, not those of the
+    // umask, before anyone else could connect to it
+    int Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    auto Mask = umask(0177);
+    bool Bound = Fd >= 0 && bind(Fd, (const sockaddr *) &Address, sizeof(Address)) == 0;
+    umask(Mask);
+    if (!Bound || listen(Fd, 16) != 0) {
+        errorStream() << "error: Cannot listen at " << SocketName.string() << ": " << std::strerror(errno)
+                      << std::endl;
+        if (Fd >= 0) {
+            ::close(Fd);
+        }
+        return EXIT_FAILURE;
+    }
+
+    // Without SA_RESTART, so that accept() returns on the signals
+    struct sigaction Action;
+    std::memset(&Action, 0, sizeof(Action));
+    Action.sa_handler = stop;
+    sigaction(SIGINT, &Action, nullptr);
+    sigaction(SIGTERM, &Action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    messageStream() << "Listening at " << SocketName.string() << std::endl;
+    auto ServerDirectory = fs::current_path();
+    while (!Stopping) {
+        int Client = accept(Fd, nullptr, nullptr);
+        if (Client < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            errorStream() << "error: accept: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (isOwnUser(Client)) {
+            setTimeouts(Client);
+            serve(Client, ServerDirectory, Caches);
+        } else {
+            errorStream() << "error: Refused a client of another user" << std::endl;
+        }
+        ::close(Client);
+    }
+    ::close(Fd);
+    unlink(Address.sun_path);
+    return Stopping ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+optional<int> runClient(const fs::path &SocketName, const std::vector<std::string> &Args) {
+    sockaddr_un Address;
+    int Fd = makeAddress(SocketName, Address) ? connectTo(Address) : -1;
+    if (Fd < 0) {
+        return boost::none;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    std::vector<std::string> Request{fs::current_path().string()};
+    Request.insert(Request.end(), Args.begin(), Args.end());
+    std::string Out;
+    writeStrings(Out, Request);
+    if (!writeAll(Fd, Out.data(), Out.size())) {
+        ::close(Fd);
+        return boost::none;
+    }
+
+    char Kind;
+    std::string Data;
+    while (readFrame(Fd, Kind, Data)) {
+        if (Kind == 'O') {
+            std::cout << Data << std::flush;
+        } else if (Kind == 'E') {
+            std::cerr << Data << std::flush;
+        } else if (Kind == 'X' && Data.size() == 4) {
+            ::close(Fd);
+            return (int) get32(Data.data());
+        }
+    }
+    ::close(Fd);
+    std::cerr << "error: The server at " << SocketName.string() << " closed the connection" << std::endl;
+    return EXIT_FAILURE;
+}
+
+#else
+
+int runServer(const fs::path &SocketName, std::shared_ptr<AssemblerCaches> Caches) {
+    errorStream() << "error: --server needs Unix domain sockets" << std::endl;
+    return EXIT_FAILURE;
+}
+
+optional<int> runClient(const fs::path &SocketName, const std::vector<std::string> &Args) {
+    return boost::none;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SJASMPLUS_SERVER_H
+#define SJASMPLUS_SERVER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "fs.h"
+
+using boost::optional;
+
+struct AssemblerCaches;
+
+// Resident assembler (--server) and its client (--client), talking through
+// a Unix domain socket. The client sends one request per connection:
+//
+//   u32 count, then count strings of u32 length and bytes: the working
+//   directory, then the arguments of the command line
+//
+// and the server answers with frames of a kind byte, u32 length and bytes:
+// 'O' and 'E' for text of cout and cerr as it is printed, then 'X' with the
+// u32 exit code. Integers are little-endian.
+//
+// Requests are assembled one by one in the working directory of each, as
+// the directory is shared by the whole process. The cached files and packed
+// data of the server stay warm between requests, the include directories
+// are searched again for each.
+
+// Returns the exit code after SIGINT or SIGTERM
+int runServer(const fs::path &SocketName, std::shared_ptr<AssemblerCaches> Caches);
+
+// Exit code of the assembly by the server, none if there is no server
+optional<int> runClient(const fs::path &SocketName, const std::vector<std::string> &Args);
+
+#endif //SJASMPLUS_SERVER_H
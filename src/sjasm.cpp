@@ -31,6 +31,11 @@
 int main(int argc, char *argv[]) {
 
     int RetValue;
-    Assembler Asm(argc, argv, RetValue);
+    try {
+        Assembler Asm(argc, argv, RetValue);
+    } catch (AssemblyAborted &E) {
+        // Fatal errors of the options, before the assembler catches them
+        RetValue = E.ExitCode;
+    }
     return RetValue;
 }
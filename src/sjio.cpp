@@ -29,6 +29,7 @@
 #include <string>
 #include <iostream>
 #include <array>
+#include <iterator>
 #include <boost/version.hpp>
 #include <parser/macro.h>
 
@@ -42,13 +43,14 @@ using namespace std::string_literals;
 #include "options.h"
 #include "support.h"
 #include "codeemitter.h"
+#include "io_tape.h"
 
 #include "sjio.h"
 
 // FIXME: errors.cpp
-extern Assembler *Asm;
+extern thread_local Assembler *Asm;
 
-bool SourceReaderEnabled = false; // Reset by the END directive
+thread_local bool SourceReaderEnabled = false; // Reset by the END directive
 
 void enableSourceReader() {
     SourceReaderEnabled = true;
@@ -116,14 +118,14 @@ public:
         } else return false;
     }
 
-    std::streamsize read(fs::ifstream &IFS) {
+    std::streamsize read(std::istream &IFS) {
         IFS.read((char *) this->data(), this->size());
         this->reset(IFS.gcount());
         return BytesLeft;
     }
 };
 
-TyReadLineBuf ReadLineBuf;
+thread_local TyReadLineBuf ReadLineBuf;
 
 // Temporary
 void clearReadLineBuf() {
@@ -131,10 +133,21 @@ void clearReadLineBuf() {
 }
 // --
 
-bool rl_InDQuotes = false, rl_InSQuotes = false, rl_InInstr = false, rl_InComment = false, rl_AfterColon = false, rlnewline = true;
+thread_local bool rl_InDQuotes = false, rl_InSQuotes = false, rl_InInstr = false, rl_InComment = false, rl_AfterColon = false, rlnewline = true;
 
-fs::ifstream realIFS;
-fs::ifstream *pIFS = &realIFS;
+thread_local CachedFileStream realIFS;
+thread_local CachedFileStream *pIFS = &realIFS;
+
+// An aborted assembly may have left its state behind on the thread
+void resetSourceReader() {
+    ReadLineBuf.clear();
+    rl_InDQuotes = rl_InSQuotes = rl_InInstr = rl_InComment = rl_AfterColon = false;
+    rlnewline = true;
+    realIFS.close();
+    realIFS.clear();
+    pIFS = &realIFS;
+}
+// --
 
 /*
 void CheckPage() {
@@ -165,7 +178,7 @@ void emit(uint8_t byte) {
         auto err = Asm->Em.emitByte(byte);
         if (err) Fatal(*err);
     } else {
-        Asm->Em.incAddress();
+        Asm->Em.emitSizeOnly(1);
     }
 }
 
@@ -216,17 +229,27 @@ void emitBlock(uint8_t Byte, aint Len, bool NoFill) {
     if (Len) {
         Asm->Listing.addByte(Byte);
     }
-    while (Len--) {
-        if (pass == LASTPASS) {
-            if (!NoFill) {
-                auto err = Asm->Em.emitByte(Byte);
-                if (err) Fatal(*err);
-            } else {
-                Asm->Em.incAddress();
-            }
-        } else {
-            Asm->Em.incAddress();
-        }
+    if (Len <= 0) {
+        return;
+    }
+    if (NoFill) {
+        Asm->Em.incAddress((size_t) Len);
+    } else if (pass == LASTPASS) {
+        auto err = Asm->Em.emitFill(Byte, (size_t) Len);
+        if (err) Fatal(*err);
+    } else {
+        Asm->Em.emitSizeOnly((size_t) Len);
+    }
+}
+
+void emitSpan(const uint8_t *Bytes, size_t Size) {
+    Asm->Listing.setPreviousAddress(Asm->Em.getCPUAddress());
+    Asm->Listing.addBytes(Bytes, Size);
+    if (pass == LASTPASS) {
+        auto err = Asm->Em.emitSpan(Bytes, Size);
+        if (err) Fatal(*err);
+    } else {
+        Asm->Em.emitSizeOnly(Size);
     }
 }
 
@@ -277,6 +300,20 @@ char* GetPath(const char* fname, TCHAR** filenamebegin) {
 fs::path resolveIncludeFilename(const fs::path &FN) {
     auto Res = Asm->getAbsPath(FN);
     if (!fs::exists(Res)) {
+        // Found in the include directories before. A file added since to a
+        // directory searched earlier is not noticed, see FileCache.
+        std::string Key = Res.string();
+        for (const auto *L : {&Asm->options().CmdLineIncludeDirsList, &Asm->options().IncludeDirsList}) {
+            for (const auto &P : *L) {
+                Key += '\n' + P.string();
+            }
+            Key += '\n';
+        }
+        auto Found = Asm->Files.findResolved(Key);
+        if (Found && fs::exists(*Found)) {
+            return *Found;
+        }
+
         bool CmdLineIncludesFirst =
                 !FN.empty() && FN.string()[0] == '<' &&
                 FN.string()[FN.string().size() - 1] == '>';
@@ -308,6 +345,9 @@ fs::path resolveIncludeFilename(const fs::path &FN) {
                 }
             }
         }
+        if (Done) {
+            Asm->Files.addResolved(Key, Res);
+        }
     }
     return Res;
 }
@@ -315,6 +355,7 @@ fs::path resolveIncludeFilename(const fs::path &FN) {
 void includeBinaryFile(const fs::path &FileName, int Offset, int Length) {
 
     fs::path AbsFilePath = resolveIncludeFilename(FileName);
+    flushOutputFiles();
 
     uint16_t DestAddr = Asm->Em.getEmitAddress();
     if ((int) DestAddr + Length > 0x10000)
@@ -322,41 +363,60 @@ void includeBinaryFile(const fs::path &FileName, int Offset, int Length) {
               "\" won't fit at current address="s +
               std::to_string(DestAddr));
 
-    fs::ifstream IFS(AbsFilePath, std::ios_base::binary);
-    if (!IFS) Fatal("Error opening file"s, FileName.string());
+    auto Data = Asm->Files.read(AbsFilePath);
+    if (!Data) Fatal("Error opening file"s, FileName.string());
     if (Length < 0) Fatal("BinIncFile(): len < 0"s, FileName.string());
     if (Length == 0) {
         // Load whole file
-        IFS.seekg(0, std::ios_base::end);
-        Length = IFS.tellg();
-        IFS.seekg(0, std::ios_base::beg);
-    }
-    if (Offset > 0) {
-        IFS.seekg(Offset, IFS.beg);
-        if (IFS.tellg() != Offset) {
-            Fatal("Offset ("s + std::to_string(Offset) + ") is beyond file length"s,
-                  FileName.string());
-        }
+        Length = (int) Data->size();
     }
     if (Length > 0) {
-        char Byte;
-        auto Remaining = Length;
-        while (Remaining > 0) {
-            if (!IFS.get(Byte)) {
-                Fatal("Could not read "s + std::to_string(Length) + " bytes. File too small?",
-                        FileName.string());
-            }
-            auto err = Asm->Em.emitByte(Byte);
-            if (err) Fatal(*err, FileName.string());
-            Remaining--;
+        auto Available = (int) std::max((std::streamoff) 0, (std::streamoff) Data->size() - Offset);
+        // Only the size matters in the sizing pass
+        auto err = Asm->Em.emitSpan(Asm->Em.isSizingPass() ? nullptr : (const uint8_t *) Data->data() + Offset,
+                                    std::min(Length, Available));
+        if (err) Fatal(*err, FileName.string());
+        if (Available < Length) {
+            Fatal("Could not read "s + std::to_string(Length) + " bytes. File too small?",
+                    FileName.string());
         }
     }
-    IFS.close();
+}
+
+void includePackedFile(const fs::path &FileName, int Offset, int Length, packers::Method Method) {
+
+    fs::path AbsFilePath = resolveIncludeFilename(FileName);
+    flushOutputFiles();
+
+    // The packed size is needed in every pass, cached results make the
+    // later passes cheap
+    auto File = Asm->Files.read(AbsFilePath);
+    if (!File) Fatal("Error opening file"s, FileName.string());
+    const std::string &Data = *File;
+    if (Offset > (int) Data.size()) {
+        Fatal("Offset ("s + std::to_string(Offset) + ") is beyond file length"s, FileName.string());
+    }
+    if (Length == 0) {
+        Length = (int) Data.size() - Offset;
+    } else if (Offset + Length > (int) Data.size()) {
+        Fatal("Could not read "s + std::to_string(Length) + " bytes. File too small?", FileName.string());
+    }
+    std::string Packed;
+    auto err = Asm->Packs.pack(Asm->options().PackCacheDir, Method, Data.substr(Offset, Length), Packed);
+    if (err) Fatal(*err, FileName.string());
+
+    uint16_t DestAddr = Asm->Em.getEmitAddress();
+    if ((int) DestAddr + (int) Packed.size() > 0x10000)
+        Fatal(std::to_string(Packed.size()) + " packed bytes of file \""s + FileName.string() +
+              "\" won't fit at current address="s +
+              std::to_string(DestAddr));
+    err = Asm->Em.emitSpan((const uint8_t *) Packed.data(), Packed.size());
+    if (err) Fatal(*err, FileName.string());
 }
 
 void includeFile(const fs::path &IncFileName) {
-    fs::ifstream *saveIFS = pIFS;
-    fs::ifstream incIFS;
+    CachedFileStream *saveIFS = pIFS;
+    CachedFileStream incIFS;
     pIFS = &incIFS;
 //std::cout << "*** INCLUDE: " << nfilename << std::endl;
     TyReadLineBuf SaveReadLineBuf = ReadLineBuf;
@@ -528,7 +588,7 @@ void readBufLine(bool Parse, bool SplitByColon) {
     }
 }
 
-int SaveRAM(fs::ofstream &ofs, int start, int length) {
+int SaveRAM(MemModel &M, fs::ofstream &ofs, int start, int length) {
     //unsigned int addadr = 0,save = 0;
 /*
     aint save = 0;
@@ -547,7 +607,7 @@ int SaveRAM(fs::ofstream &ofs, int start, int length) {
     }
 
     auto *data = new char[length];
-    Asm->Em.getBytes((uint8_t *) data, start, length);
+    M.readSpan((uint8_t *) data, start, length);
     ofs.write(data, length);
     delete[] data;
     if (ofs.fail()) {
@@ -583,7 +643,7 @@ int SaveRAM(fs::ofstream &ofs, int start, int length) {
     return 1;
 }
 
-void *SaveRAM(void *dst, int start, int length) {
+void *SaveRAM(MemModel &M, void *dst, int start, int length) {
 /*
     if (!DeviceID) {
         return 0;
@@ -598,7 +658,7 @@ void *SaveRAM(void *dst, int start, int length) {
         length = 0x10000 - start;
     }
 
-    Asm->Em.getBytes(target, start, length);
+    M.readSpan(target, start, length);
     target += length;
 
 /*
@@ -644,7 +704,13 @@ uint8_t memGetByte(uint16_t address) {
 }
 
 
-bool saveBinaryFile(const fs::path &FileName, int Start, int Length) {
+void flushOutputFiles() {
+    Asm->Saves.waitAll();
+    TRD_Flush();
+    zx::flushTAP();
+}
+
+bool saveBinaryFile(MemModel &M, const fs::path &FileName, int Start, int Length) {
 
     fs::ofstream OFS(FileName, std::ios_base::binary);
     if (!OFS) {
@@ -658,11 +724,39 @@ bool saveBinaryFile(const fs::path &FileName, int Start, int Length) {
     }
 
     //_COUT "Start: " _CMDL start _CMDL " Length: " _CMDL length _ENDL;
-    SaveRAM(OFS, Start, Length);
+    SaveRAM(M, OFS, Start, Length);
     OFS.close();
     return !OFS.fail();
 }
 
+optional<std::string> savePackedFile(MemModel &M, const fs::path &FileName, int Start, int Length,
+                                     packers::Method Method) {
+    if (Length + Start > 0xFFFF) {
+        Length = -1;
+    }
+    if (Length <= 0) {
+        Length = 0x10000 - Start;
+    }
+    std::string Data((size_t) Length, '\0');
+    M.readSpan((uint8_t *) &Data[0], (uint16_t) Start, (size_t) Length);
+    std::string Packed;
+    auto Err = Asm->Packs.pack(Asm->options().PackCacheDir, Method, Data, Packed);
+    if (Err) {
+        return Err;
+    }
+
+    fs::ofstream OFS(FileName, std::ios_base::binary);
+    if (!OFS) {
+        Fatal("Error opening file: "s + FileName.string());
+    }
+    OFS.write(Packed.data(), Packed.size());
+    OFS.close();
+    if (OFS.fail()) {
+        return "Error writing file (Disk full?)"s;
+    }
+    return boost::none;
+}
+
 EReturn readFile(const char *pp, const char *err) {
     const char *p;
     while (ReadLineBuf.left() > 0 || !pIFS->eof()) {
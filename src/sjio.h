@@ -36,6 +36,7 @@
 #include "errors.h"
 #include "tables.h"
 #include "io_trd.h"
+#include "packers.h"
 #include "util.h"
 
 using boost::optional;
@@ -54,6 +55,9 @@ void emitWords(int *words);
 
 void emitBlock(uint8_t Byte, aint Len, bool NoFill = false);
 
+// Emit and list Size bytes at once, the same as emitting them one by one
+void emitSpan(const uint8_t *Bytes, size_t Size);
+
 fs::path resolveIncludeFilename(const fs::path &FN);
 
 void includeFile(const fs::path &IncFileName);
@@ -63,13 +67,22 @@ void readBufLine(bool Parse = true, bool SplitByColon = true); /* added */
 // char *GetPath(const char *fname, TCHAR **filenamebegin); /* added */
 void includeBinaryFile(const fs::path &FileName, int Offset, int Length);
 
-int SaveRAM(fs::ofstream &ofs, int, int);
+// Emit Length bytes (0 for the rest) of the file from Offset, packed
+void includePackedFile(const fs::path &FileName, int Offset, int Length, packers::Method Method);
+
+int SaveRAM(MemModel &M, fs::ofstream &ofs, int, int);
 
-void *SaveRAM(void *dst, int start, int size);
+void *SaveRAM(MemModel &M, void *dst, int start, int size);
 
 uint8_t memGetByte(uint16_t address); /* added */
 uint16_t memGetWord(uint16_t address); /* added */
-bool saveBinaryFile(const fs::path &FileName, int Start, int Length);
+bool saveBinaryFile(MemModel &M, const fs::path &FileName, int Start, int Length);
+
+optional<std::string> savePackedFile(MemModel &M, const fs::path &FileName, int Start, int Length,
+                                     packers::Method Method);
+
+// Finish writing the files of SAVE* pseudo-ops before files are read back
+void flushOutputFiles();
 
 int readLine(bool SplitByColon = true);
 
@@ -0,0 +1,40 @@
+#ifndef SJASMPLUS_SPSCRING_H
+#define SJASMPLUS_SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free bounded queue for exactly one producer and one consumer thread
+template<typename T, size_t Capacity>
+class SPSCRing {
+private:
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    T Slots[Capacity];
+    // Keep the indices on separate cache lines
+    alignas(64) std::atomic<size_t> Head{0}; // next slot to read
+    alignas(64) std::atomic<size_t> Tail{0}; // next slot to write
+
+public:
+    // Producer side, returns false if the ring is full
+    bool push(const T &Value) {
+        auto Pos = Tail.load(std::memory_order_relaxed);
+        if (Pos - Head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        Slots[Pos % Capacity] = Value;
+        Tail.store(Pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, returns false if the ring is empty
+    bool pop(T &Value) {
+        auto H = Head.load(std::memory_order_relaxed);
+        if (H == Tail.load(std::memory_order_acquire))
+            return false;
+        Value = Slots[H % Capacity];
+        Head.store(H + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif //SJASMPLUS_SPSCRING_H
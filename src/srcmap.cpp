@@ -0,0 +1,162 @@
+#include <iterator>
+#include <map>
+#include "lebytes.h"
+#include "srcmap.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+const char Magic[8] = {'S', 'J', 'S', 'R', 'C', 'M', 'A', 'P'};
+const uint32_t Version = 2;
+
+} // namespace
+
+uint32_t SourceMapWriter::fileId(const std::string &File) {
+    // Consecutive ranges nearly always come from the same file
+    if (!Files.empty() && File == LastFile) {
+        return LastFileId;
+    }
+    auto It = FileIds.find(File);
+    if (It == FileIds.end()) {
+        It = FileIds.emplace(File, (uint32_t) Files.size()).first;
+        Files.push_back(File);
+    }
+    LastFile = File;
+    LastFileId = It->second;
+    return LastFileId;
+}
+
+void SourceMapWriter::add(int Page, uint16_t Address, size_t Size, const std::string &File, uint32_t Line,
+                          int MacroDepth) {
+    if (Size == 0) {
+        return;
+    }
+    if (Page >= 0) {
+        Address %= SlotSize;
+    }
+    Range R{Page, Address, (uint32_t) Size, fileId(File), Line, (uint32_t) MacroDepth};
+    if (!Ranges.empty()) {
+        // Extend the previous range with the next bytes of the same line
+        auto &L = Ranges.back();
+        if (L.Page == R.Page && (uint32_t) L.Address + L.Size == R.Address &&
+            L.File == R.File && L.Line == R.Line && L.MacroDepth == R.MacroDepth) {
+            L.Size += R.Size;
+            return;
+        }
+    }
+    Ranges.push_back(R);
+}
+
+std::vector<SourceMapWriter::Range> SourceMapWriter::flatten() const {
+    // Non-overlapping ranges by page and start address. Ranges never cross
+    // a page, so keys of one page are contiguous.
+    std::map<uint64_t, Range> Map;
+    for (const auto &R : Ranges) {
+        uint64_t Begin = (uint64_t) (R.Page + 1) << 16 | R.Address;
+        uint64_t End = Begin + R.Size;
+        auto It = Map.lower_bound(Begin);
+        if (It != Map.begin()) {
+            auto Prev = std::prev(It);
+            uint64_t PrevEnd = Prev->first + Prev->second.Size;
+            if (PrevEnd > Begin) {
+                if (PrevEnd > End) {
+                    Range Tail = Prev->second;
+                    Tail.Address = (uint16_t) (End & 0xffff);
+                    Tail.Size = (uint32_t) (PrevEnd - End);
+                    Map.emplace(End, Tail);
+                }
+                Prev->second.Size = (uint32_t) (Begin - Prev->first);
+            }
+        }
+        It = Map.lower_bound(Begin);
+        while (It != Map.end() && It->first < End) {
+            uint64_t ItEnd = It->first + It->second.Size;
+            if (ItEnd > End) {
+                Range Tail = It->second;
+                Tail.Address = (uint16_t) (End & 0xffff);
+                Tail.Size = (uint32_t) (ItEnd - End);
+                Map.emplace(End, Tail);
+            }
+            It = Map.erase(It);
+        }
+        Map.emplace(Begin, R);
+    }
+
+    std::vector<Range> Sorted;
+    Sorted.reserve(Map.size());
+    for (const auto &E : Map) {
+        const auto &R = E.second;
+        if (!Sorted.empty()) {
+            auto &L = Sorted.back();
+            if (L.Page == R.Page && (uint32_t) L.Address + L.Size == R.Address &&
+                L.File == R.File && L.Line == R.Line && L.MacroDepth == R.MacroDepth) {
+                L.Size += R.Size;
+                continue;
+            }
+        }
+        Sorted.push_back(R);
+    }
+    return Sorted;
+}
+
+optional<std::string> SourceMapWriter::write() const {
+    fs::ofstream OFS(FileName, std::ios::binary);
+    if (!OFS) {
+        return "Error opening file: "s + FileName.string();
+    }
+    auto Sorted = flatten();
+
+    std::string FileTable;
+    for (const auto &F : Files) {
+        put32(FileTable, (uint32_t) F.size());
+        FileTable += F;
+    }
+
+    std::string Index, Data;
+    Range Prev{};
+    for (size_t i = 0; i < Sorted.size(); i++) {
+        const auto &R = Sorted[i];
+        if (i % RangesPerEntry == 0) {
+            put16(Index, (uint16_t) R.Page);
+            put16(Index, R.Address);
+            put32(Index, R.File);
+            put32(Index, R.Line);
+            put32(Index, (uint32_t) Data.size());
+            Prev = R;
+            Prev.Size = 0;
+        }
+        putVarint(Data, zigzag(R.Page - Prev.Page));
+        if (R.Page == Prev.Page) {
+            putVarint(Data, (uint64_t) (R.Address - (Prev.Address + Prev.Size)));
+        } else {
+            putVarint(Data, R.Address);
+        }
+        putVarint(Data, R.Size);
+        putVarint(Data, zigzag((int64_t) R.File - Prev.File));
+        putVarint(Data, zigzag((int64_t) R.Line - Prev.Line));
+        putVarint(Data, R.MacroDepth);
+        Prev = R;
+    }
+
+    const size_t HeaderSize = sizeof(Magic) + 4 * 5 + 8 * 3;
+    std::string Header{Magic, sizeof(Magic)};
+    put32(Header, Version);
+    put32(Header, (uint32_t) Files.size());
+    put32(Header, (uint32_t) Sorted.size());
+    put32(Header, (uint32_t) ((Sorted.size() + RangesPerEntry - 1) / RangesPerEntry));
+    put32(Header, RangesPerEntry);
+    put64(Header, HeaderSize);
+    put64(Header, HeaderSize + FileTable.size());
+    put64(Header, HeaderSize + FileTable.size() + Index.size());
+
+    OFS.write(Header.data(), Header.size());
+    OFS.write(FileTable.data(), FileTable.size());
+    OFS.write(Index.data(), Index.size());
+    OFS.write(Data.data(), Data.size());
+    OFS.close();
+    if (!OFS) {
+        return "Error writing file: "s + FileName.string();
+    }
+    return boost::none;
+}
@@ -0,0 +1,78 @@
+#ifndef SJASMPLUS_SRCMAP_H
+#define SJASMPLUS_SRCMAP_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "fs.h"
+
+using boost::optional;
+
+// Source map (--srcmap) for debuggers: which source line produced the byte at
+// a (page, offset in the page). Ranges are collected in the last pass, a later
+// write to the same memory replaces the earlier source, whichever slot the page
+// was mapped to. All integers are little-endian:
+//
+//   Header  magic "SJSRCMAP", uint32 version, uint32 number of files,
+//           ranges, index entries and ranges per index entry,
+//           uint64 offsets of the sections below
+//   Files   uint32 length and the name of each source file
+//   Index   for every RangesPerEntry ranges: int16 page, uint16 address,
+//           uint32 file, uint32 line and uint32 offset of the first range
+//           in Ranges. Sorted by page and address, i.e. binary-searchable.
+//   Ranges  sorted by page and address, each a sequence of varints:
+//           zigzag page delta, address (gap after the previous range on the
+//           same page, absolute on a new page), size, zigzag file delta,
+//           zigzag line delta, macro expansion depth.
+//           Deltas restart from the index entry at the first range of an
+//           entry, so each entry decodes on its own.
+//
+// The addresses are offsets in the page. Page is -1 if no device is set, the
+// addresses are then those of the CPU.
+class SourceMapWriter {
+private:
+    struct Range {
+        int Page;
+        // Offset in the page, or the CPU address without a device
+        uint16_t Address;
+        uint32_t Size;
+        uint32_t File;
+        uint32_t Line;
+        uint32_t MacroDepth;
+    };
+
+    fs::path FileName;
+    std::vector<Range> Ranges;
+    std::vector<std::string> Files;
+    std::unordered_map<std::string, uint32_t> FileIds;
+    std::string LastFile;
+    uint32_t LastFileId = 0;
+
+    uint32_t fileId(const std::string &File);
+
+    // Resolve overlaps in favour of later ranges and sort them
+    std::vector<Range> flatten() const;
+
+public:
+    static const uint32_t RangesPerEntry = 64;
+
+    void init(const fs::path &_FileName) {
+        FileName = _FileName;
+    }
+
+    bool isActive() const { return !FileName.empty(); }
+
+    // Pages are mapped to 16K slots
+    static const uint16_t SlotSize = 0x4000;
+
+    // Emitted Size bytes at the CPU Address (within one slot), called in the
+    // last pass
+    void add(int Page, uint16_t Address, size_t Size, const std::string &File, uint32_t Line, int MacroDepth);
+
+    optional<std::string> write() const;
+};
+
+#endif //SJASMPLUS_SRCMAP_H
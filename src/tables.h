@@ -53,6 +53,8 @@ public:
 
     bool find(const std::string &);
 
+    void clear() { Map.clear(); }
+
 private:
     std::map<std::string, void (*)(void)> Map;
 };
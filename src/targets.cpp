@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+
+#include "asm.h"
+#include "errors.h"
+#include "threadpool.h"
+#include "targets.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+struct Target {
+    std::string Name;
+    std::vector<std::string> Args;
+    int RetValue = EXIT_FAILURE;
+    double Ms = 0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point Start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+}
+
+// Arguments separated by spaces, quotes keep spaces (and the other kind of
+// quotes) in an argument
+optional<std::string> splitArgs(const std::string &Line, std::vector<std::string> &Args) {
+    auto It = Line.begin();
+    while (true) {
+        while (It != Line.end() && isspace((unsigned char) *It)) {
+            ++It;
+        }
+        if (It == Line.end()) {
+            return boost::none;
+        }
+        std::string Arg;
+        char Quote = 0;
+        for (; It != Line.end() && (Quote || !isspace((unsigned char) *It)); ++It) {
+            if (Quote ? *It == Quote : *It == '"' || *It == '\'') {
+                Quote = Quote ? 0 : *It;
+            } else {
+                Arg += *It;
+            }
+        }
+        if (Quote) {
+            return "Missing closing quote"s;
+        }
+        Args.push_back(std::move(Arg));
+    }
+}
+
+optional<std::string> readManifest(const fs::path &FileName, std::vector<Target> &Targets) {
+    fs::ifstream IFS(FileName);
+    if (!IFS) {
+        return "Error opening file: "s + FileName.string();
+    }
+    std::string Line;
+    for (int LineNumber = 1; std::getline(IFS, Line); LineNumber++) {
+        auto Where = FileName.string() + "("s + std::to_string(LineNumber) + "): "s;
+        auto First = Line.find_first_not_of(" \t\r");
+        if (First == std::string::npos || Line[First] == '#') {
+            continue;
+        }
+        auto Colon = Line.find(':', First);
+        if (Colon == std::string::npos) {
+            return Where + "Expected <name>: <options and source files>"s;
+        }
+        auto Last = Line.find_last_not_of(" \t", Colon - 1);
+        Target T;
+        T.Name = Last < First || Last == std::string::npos ? ""s : Line.substr(First, Last - First + 1);
+        if (T.Name.empty()) {
+            return Where + "No target name"s;
+        }
+        for (const auto &Other : Targets) {
+            if (Other.Name == T.Name) {
+                return Where + "Duplicate target: "s + T.Name;
+            }
+        }
+        auto Err = splitArgs(Line.substr(Colon + 1), T.Args);
+        if (Err) {
+            return Where + *Err;
+        }
+        if (T.Args.empty()) {
+            return Where + "No source files for target: "s + T.Name;
+        }
+        Targets.push_back(std::move(T));
+    }
+    if (Targets.empty()) {
+        return "No targets in "s + FileName.string();
+    }
+    return boost::none;
+}
+
+} // namespace
+
+int buildTargets(const fs::path &FileName, const std::vector<std::string> &CommonArgs,
+                 std::shared_ptr<AssemblerCaches> Caches) {
+    std::vector<Target> Targets;
+    auto Err = readManifest(FileName, Targets);
+    if (Err) {
+        errorStream() << "error: " << *Err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto Start = Clock::now();
+    // The pool threads print to the messages of this thread
+    std::ostream &Out = messageStream();
+    std::mutex OutputMutex;
+    {
+        ThreadPool Pool{std::min(ThreadPool::defaultThreads(), (unsigned) Targets.size())};
+        for (auto &T : Targets) {
+            Pool.submit([&T, &CommonArgs, &Caches, &Out, &OutputMutex] {
+                std::vector<std::string> Args{"sjasmplus"s, "--nologo"s};
+                Args.insert(Args.end(), CommonArgs.begin(), CommonArgs.end());
+                Args.insert(Args.end(), T.Args.begin(), T.Args.end());
+                std::vector<char *> Argv;
+                for (auto &A : Args) {
+                    Argv.push_back(&A[0]);
+                }
+                Argv.push_back(nullptr);
+
+                std::ostringstream Messages;
+                redirectMessages(&Messages);
+                auto TargetStart = Clock::now();
+                try {
+                    Assembler A((int) Args.size(), Argv.data(), T.RetValue, Caches);
+                } catch (AssemblyAborted &E) {
+                    // Thrown before the assembler could catch it, by the options
+                    T.RetValue = E.ExitCode;
+                }
+                T.Ms = msSince(TargetStart);
+                redirectMessages(nullptr);
+
+                std::lock_guard<std::mutex> Lock(OutputMutex);
+                Out << "--- " << T.Name << " ---" << std::endl;
+                Out << Messages.str() << std::flush;
+            });
+        }
+        Pool.wait();
+    }
+
+    int RetValue = EXIT_SUCCESS;
+    size_t Width = 6;
+    for (const auto &T : Targets) {
+        Width = std::max(Width, T.Name.size());
+    }
+    char Buf[32];
+    _COUT "\nTarget" << std::string(Width - 6, ' ') << "          ms  result" _ENDL;
+    for (const auto &T : Targets) {
+        std::snprintf(Buf, sizeof(Buf), "%12.3f", T.Ms);
+        _COUT T.Name << std::string(Width - T.Name.size(), ' ') << Buf << "  "
+              << (T.RetValue == EXIT_SUCCESS ? "ok" : "failed") _ENDL;
+        if (T.RetValue != EXIT_SUCCESS) {
+            RetValue = EXIT_FAILURE;
+        }
+    }
+    std::snprintf(Buf, sizeof(Buf), "%12.3f", msSince(Start));
+    _COUT "Total" << std::string(Width - 5, ' ') << Buf << "  ("
+          << Targets.size() << " targets)" _ENDL;
+    return RetValue;
+}
@@ -0,0 +1,26 @@
+#ifndef SJASMPLUS_TARGETS_H
+#define SJASMPLUS_TARGETS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fs.h"
+
+struct AssemblerCaches;
+
+// Assembles the targets of the manifest (--targets) side by side, sharing
+// the caches, each with the CommonArgs before its own. A line of the manifest is a target:
+//
+//   <name>: <options and source files>
+//
+// with the options of the command line, e.g. "-DMODEL=128 --raw=game.bin
+// main.asm". Arguments are separated by spaces, as in the shell double or
+// single quotes keep spaces in an argument, e.g. -DNAME='"Game"'. Empty
+// lines and lines starting with # are skipped.
+//
+// Returns the exit code, failure if any of the targets failed.
+int buildTargets(const fs::path &FileName, const std::vector<std::string> &CommonArgs,
+                 std::shared_ptr<AssemblerCaches> Caches);
+
+#endif //SJASMPLUS_TARGETS_H
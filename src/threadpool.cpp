@@ -0,0 +1,57 @@
+#include <algorithm>
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(unsigned NumThreads) {
+    NumThreads = std::max(1u, NumThreads);
+    for (unsigned i = 0; i < NumThreads; i++) {
+        Workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+    }
+    TaskAdded.notify_all();
+    for (auto &W : Workers) {
+        W.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> Task) {
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Tasks.push_back(std::move(Task));
+    }
+    TaskAdded.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    TaskDone.wait(Lock, [this] { return Tasks.empty() && Running == 0; });
+}
+
+unsigned ThreadPool::defaultThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (true) {
+        TaskAdded.wait(Lock, [this] { return Stopping || !Tasks.empty(); });
+        if (Tasks.empty()) {
+            return;
+        }
+        auto Task = std::move(Tasks.front());
+        Tasks.pop_front();
+        Running++;
+        Lock.unlock();
+        Task();
+        Lock.lock();
+        Running--;
+        if (Tasks.empty() && Running == 0) {
+            TaskDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef SJASMPLUS_THREADPOOL_H
+#define SJASMPLUS_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed number of worker threads running submitted tasks in FIFO order
+class ThreadPool {
+private:
+    std::vector<std::thread> Workers;
+    std::deque<std::function<void()>> Tasks;
+    std::mutex Mutex;
+    std::condition_variable TaskAdded;
+    std::condition_variable TaskDone;
+    size_t Running = 0;
+    bool Stopping = false;
+
+    void workerLoop();
+
+public:
+    explicit ThreadPool(unsigned NumThreads);
+
+    ~ThreadPool();
+
+    void submit(std::function<void()> Task);
+
+    // Block until all submitted tasks have finished
+    void wait();
+
+    // Hardware threads, at least 1
+    static unsigned defaultThreads();
+};
+
+#endif //SJASMPLUS_THREADPOOL_H
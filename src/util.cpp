@@ -1,4 +1,5 @@
 #include <string>
+#include <boost/version.hpp>
 #include "errors.h"
 #include "util.h"
 
@@ -30,54 +31,45 @@ std::string toHex16(aint Number) {
 }
 
 std::string toHex32(aint Number) {
-    aint N = Number & 0xffffffff;
     std::string S;
-    S = hd[N >> 28];
-    N &= 0xfffffff;
-    S += hd[N >> 24];
-    N &= 0xffffff;
-    S += hd[N >> 20];
-    N &= 0xfffff;
-    S += hd[N >> 16];
-    N &= 0xffff;
-    S += hd[N >> 12];
-    N &= 0xfff;
-    S += hd[N >> 8];
-    N &= 0xff;
-    S += hd[N >> 4];
-    N &= 0xf;
-    S += hd[N];
+    appendHex32(S, Number);
     return S;
 }
 
 /* added */
 std::string toHexAlt(aint Number) {
-    aint N = Number & 0xffffffff;
     std::string S;
-    if (N >> 28 != 0) {
-        S += hd[N >> 28];
-    }
-    N &= 0xfffffff;
-    if (N >> 24 != 0) {
-        S += hd[N >> 24];
-    }
-    N &= 0xffffff;
-    if (N >> 20 != 0) {
-        S += hd[N >> 20];
+    appendHexAlt(S, Number);
+    return S;
+}
+
+void appendHex32(std::string &Out, aint Number) {
+    auto N = (uint32_t) Number;
+    for (int Shift = 28; Shift >= 0; Shift -= 4) {
+        Out += hd[(N >> Shift) & 15];
     }
-    N &= 0xfffff;
-    if (N >> 16 != 0) {
-        S += hd[N >> 16];
+}
+
+// The low 4 digits always, the upper ones only if they are not zero
+void appendHexAlt(std::string &Out, aint Number) {
+    auto N = (uint32_t) Number;
+    for (int Shift = 28; Shift >= 0; Shift -= 4) {
+        auto Digit = (N >> Shift) & 15;
+        if (Digit != 0 || Shift < 16) {
+            Out += hd[Digit];
+        }
     }
-    N &= 0xffff;
-    S += hd[N >> 12];
-    N &= 0xfff;
-    S += hd[N >> 8];
-    N &= 0xff;
-    S += hd[N >> 4];
-    N &= 0xf;
-    S += hd[N];
-    return S;
+}
+
+fs::path fileKey(const fs::path &FileName) {
+    auto Abs = fs::absolute(FileName);
+#if (BOOST_VERSION >= 106000)
+    boost::system::error_code EC;
+    auto Canonical = fs::weakly_canonical(Abs, EC);
+    return EC ? Abs.lexically_normal() : Canonical;
+#else
+    return Abs;
+#endif
 }
 
 TextOutput::~TextOutput() {
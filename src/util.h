@@ -13,6 +13,14 @@ std::string toHex32(aint Number);
 
 std::string toHexAlt(aint Number);
 
+// Append the same digits as toHex32()/toHexAlt() without temporaries
+void appendHex32(std::string &Out, aint Number);
+
+void appendHexAlt(std::string &Out, aint Number);
+
+// One key for every spelling of a file, e.g. a.bin, ./a.bin and sub/../a.bin
+fs::path fileKey(const fs::path &FileName);
+
 class TextOutput {
 protected:
     fs::ofstream OFS;
@@ -37,11 +37,11 @@
 #include "z80.h"
 
 // FIXME: errors.cpp
-extern Assembler *Asm;
+extern thread_local Assembler *Asm;
 
 namespace Z80 {
 
-struct {
+thread_local struct {
     bool FakeInstructions = false;
     options::target Target = options::target::Z80;
     bool IsReversePOP = false;
@@ -112,9 +112,9 @@ enum Z80Cond {
 //skipWhiteSpace(my_p);
 //Warning("Fake instructions is disabled. The instruction was not compiled", my_p, LASTPASS);
 
-FunctionTable OpCodeTable;
+thread_local FunctionTable OpCodeTable;
 
-const char *BOI;
+thread_local const char *BOI;
 
 void errorIfI8080() {
     if (Options.Target == options::target::i8080) {
@@ -5434,7 +5434,10 @@ void OpCode_XOR() {
 }
 
 /* modified */
+// The table of the calling thread, rebuilt for each assembly as it depends
+// on the options
 void Init() {
+    OpCodeTable.clear();
     OpCodeTable.insert("adc"s, OpCode_ADC);
     OpCodeTable.insert("add"s, OpCode_ADD);
     OpCodeTable.insert("and"s, OpCode_AND);
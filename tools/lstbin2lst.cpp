@@ -0,0 +1,116 @@
+// Renders a binary listing written by sjasmplus --lst-bin as the classic
+// text listing, or looks up lines by address or by source file and line.
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lstbin.h"
+
+using namespace std::string_literals;
+
+namespace {
+
+void usage() {
+    std::cerr << "Usage: lstbin2lst [-j<threads>] <file.lstb> [<output.lst>]\n"
+                 "         Render the text listing to <output.lst> or to stdout\n"
+                 "       lstbin2lst <file.lstb> --addr=<hex address>[,<page>]\n"
+                 "       lstbin2lst <file.lstb> --line=<source file>:<line>\n"
+                 "         Print the listed lines for an address or a source line\n";
+    std::exit(EXIT_FAILURE);
+}
+
+// Each thread formats a contiguous range of records, the parts are written in order
+void render(const BinaryListingReader &Lst, std::ostream &OS, unsigned NumThreads) {
+    size_t N = Lst.numRecords();
+    NumThreads = (unsigned) std::max<size_t>(1, std::min<size_t>(NumThreads, N / 4096 + 1));
+    std::vector<std::string> Parts(NumThreads);
+    std::vector<std::thread> Threads;
+    for (unsigned t = 0; t < NumThreads; t++) {
+        Threads.emplace_back([&Lst, &Parts, t, N, NumThreads]() {
+            size_t Begin = N * t / NumThreads;
+            size_t End = N * (t + 1) / NumThreads;
+            for (size_t i = Begin; i < End; i++) {
+                formatListingLine(Parts[t], Lst.line(i));
+            }
+        });
+    }
+    for (unsigned t = 0; t < NumThreads; t++) {
+        Threads[t].join();
+        OS.write(Parts[t].data(), Parts[t].size());
+        std::string().swap(Parts[t]);
+    }
+}
+
+void printLines(const BinaryListingReader &Lst, const std::vector<uint32_t> &Found) {
+    for (auto i : Found) {
+        const auto &R = Lst.record(i);
+        std::string Out = Lst.files()[R.FileId] + ":"s + std::to_string(R.Line);
+        if (R.Page >= 0) {
+            Out += " page "s + std::to_string(R.Page);
+        }
+        Out += ": "s;
+        formatListingLine(Out, Lst.line(i));
+        std::cout << Out;
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    unsigned NumThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> Files;
+    std::string Addr, Line;
+    for (int i = 1; i < argc; i++) {
+        std::string A{argv[i]};
+        if (A.compare(0, 2, "-j") == 0 && A.size() > 2) {
+            NumThreads = (unsigned) std::max(1, std::atoi(A.c_str() + 2));
+        } else if (A.compare(0, 7, "--addr=") == 0) {
+            Addr = A.substr(7);
+        } else if (A.compare(0, 7, "--line=") == 0) {
+            Line = A.substr(7);
+        } else if (!A.empty() && A[0] == '-') {
+            usage();
+        } else {
+            Files.push_back(A);
+        }
+    }
+    if (Files.empty() || Files.size() > 2 || ((!Addr.empty() || !Line.empty()) && Files.size() != 1)) {
+        usage();
+    }
+
+    BinaryListingReader Lst;
+    auto Err = Lst.load(Files[0]);
+    if (!Err.empty()) {
+        std::cerr << Err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!Addr.empty()) {
+        auto Comma = Addr.find(',');
+        int Page = Comma == std::string::npos ? -1 : std::atoi(Addr.c_str() + Comma + 1);
+        auto Value = std::strtoul(Addr.c_str(), nullptr, 16);
+        printLines(Lst, Lst.findAddress((uint16_t) Value, Page));
+    } else if (!Line.empty()) {
+        auto Colon = Line.rfind(':');
+        if (Colon == std::string::npos) {
+            usage();
+        }
+        auto Number = std::strtoul(Line.c_str() + Colon + 1, nullptr, 10);
+        printLines(Lst, Lst.findLine(Line.substr(0, Colon), (uint32_t) Number));
+    } else if (Files.size() == 2) {
+        std::ofstream OFS(Files[1]);
+        if (!OFS) {
+            std::cerr << "Error opening file " << Files[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+        render(Lst, OFS, NumThreads);
+    } else {
+        render(Lst, std::cout, NumThreads);
+    }
+    return EXIT_SUCCESS;
+}